@@ -1,16 +1,66 @@
 // Example Vitis HLS C++ code for synthesizing the audio generator to FPGA RTL.
 // This is a top-level function that generates a buffer of mixed sine sweep samples.
 // Host code (not shown) would generate random freqs, call the kernel via Vitis API, stream to audio.
-// Use fixed-point for better FPGA efficiency; here using float for simplicity.
-// Include <hls_math.h> for sinf().
+// Float by default; audio_synth_t takes the sample and phase types.
+// Sine through SINE_POLICY (dsp/sine.h), via num::sin_turns.
 
 #include <hls_stream.h>
 #include <hls_math.h>
 #include <ap_fixed.h>
 
+#include "dsp/numeric.h"
+
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "dsp/simd.h"
+#include "dsp/simd_math.h"
+#endif
+
 #define NUM_OSC 32
 #define PI 3.141592653589793f
 
+// The sweep on any sample and phase types (dsp/numeric.h): float, double,
+// ap_fixed<W,I>, num::Q15 or num::Q31. The phase counts turns and wraps every
+// sample; the frequency ramp stays in float. The mix accumulates in the
+// sample type's accumulator.
+template <typename Sample, typename Phase>
+void audio_synth_t(
+    const float* starts,
+    const float* ends,
+    Sample* output,
+    int num_samples,
+    float sample_rate
+) {
+    Phase phases[NUM_OSC];
+    for (int osc = 0; osc < NUM_OSC; ++osc) {
+#pragma HLS UNROLL
+        phases[osc] = 0;
+    }
+    const Sample gain = 0.06;
+
+gen_loop:
+    for (int i = 0; i < num_samples; ++i) {
+#pragma HLS PIPELINE II=1
+        float t = (float)i / sample_rate;
+        typename num::Traits<Sample>::accum_type mix = 0;
+
+        for (int osc = 0; osc < NUM_OSC; ++osc) {
+#pragma HLS UNROLL
+            float freq = starts[osc] + (ends[osc] - starts[osc]) * (t / 60.0f);
+            phases[osc] += Phase(freq / sample_rate);
+            num::wrap_turns(phases[osc]);
+            mix += num::sin_turns<Sample>(phases[osc]) * gain;
+        }
+
+        output[i] = mix;
+    }
+}
+
 // Top function for HLS
 extern "C" {
 void audio_synth(
@@ -27,28 +77,196 @@ void audio_synth(
 #pragma HLS INTERFACE s_axilite port=sample_rate bundle=control
 #pragma HLS INTERFACE s_axilite port=return bundle=control
 
-    float phases[NUM_OSC];
-    for (int osc = 0; osc < NUM_OSC; ++osc) {
-#pragma HLS UNROLL
-        phases[osc] = 0.0f;
+    audio_synth_t<float, float>(starts, ends, output, num_samples, sample_rate);
+}
+}
+
+// Note: for FPGA efficiency, instantiate audio_synth_t on ap_fixed samples and
+// an ap_ufixed<W,0> phase (bench/precision_bench.cpp reports the noise of each
+// choice), and pick the sine with SINE_POLICY: sine::Lut<12> by default,
+// sine::Cordic<N> to spend no multipliers (bench/sine_bench.cpp has the
+// error and cost of each).
+
+#ifndef __SYNTHESIS__
+// CPU oscillator-bank path for offline renders (not synthesized).
+// Same buffer contract as audio_synth. The 32 oscillators run in SIMD lanes
+// (simd::kWidth per vector: 16 with AVX-512, 8 with AVX2, 4 with SSE2), the
+// sine is the vector polynomial from dsp/simd_math.h, and the per-sample
+// freq / sample_rate divide becomes a precomputed linear ramp of the phase
+// increment. Phase is kept in turns and wrapped every sample, as in
+// audio_synth_t.
+extern "C" void audio_synth_simd(
+    const float* starts,
+    const float* ends,
+    float* output,
+    int num_samples,
+    float sample_rate
+) {
+    const int NUM_VEC = (NUM_OSC + simd::kWidth - 1) / simd::kWidth;
+    alignas(64) float inc0[NUM_VEC * simd::kWidth];
+    alignas(64) float dinc[NUM_VEC * simd::kWidth];
+
+    // inc(i) = freq(i) / sr = start / sr + (end - start) * i / (60 * sr^2)
+    for (int osc = 0; osc < NUM_VEC * simd::kWidth; ++osc) {
+        if (osc < NUM_OSC) {
+            double sr = sample_rate;
+            inc0[osc] = (float)(starts[osc] / sr);
+            dinc[osc] = (float)((ends[osc] - starts[osc]) / (60.0 * sr * sr));
+        } else {
+            inc0[osc] = dinc[osc] = 0.0f;  // Padding lanes stay at sin(0) = 0
+        }
     }
 
-gen_loop:
+    simd::vfloat base[NUM_VEC], slope[NUM_VEC], phase[NUM_VEC];
+    for (int v = 0; v < NUM_VEC; ++v) {
+        base[v] = simd::load(inc0 + v * simd::kWidth);
+        slope[v] = simd::load(dinc + v * simd::kWidth);
+        phase[v] = simd::zero();
+    }
+
+    const simd::vfloat gain = simd::set1(0.06f);
     for (int i = 0; i < num_samples; ++i) {
-#pragma HLS PIPELINE II=1
-        float t = (float)i / sample_rate;
-        float mix = 0.0f;
+        const simd::vfloat n = simd::set1((float)i);
+        simd::vfloat mix = simd::zero();
+        for (int v = 0; v < NUM_VEC; ++v) {
+            phase[v] += simd::fmadd(slope[v], n, base[v]);
+            phase[v] -= simd::floor(phase[v]);
+            mix = simd::fmadd(simd::sin_turns(phase[v]), gain, mix);
+        }
+        output[i] = simd::hsum(mix);
+    }
+}
 
-        for (int osc = 0; osc < NUM_OSC; ++osc) {
-#pragma HLS UNROLL
-            float freq = starts[osc] + (ends[osc] - starts[osc]) * (t / 60.0f);
-            phases[osc] += 2.0f * PI * freq / sample_rate;
-            mix += sinf(phases[osc]) * 0.06f;
+// Seekable render of the same sweep. The phase of oscillator k at sample i is
+// the accumulator of audio_synth in closed form, in turns:
+//   phase(i) = sum_{j<=i} inc(j) = (i + 1) * inc0 + dinc * i * (i + 1) / 2
+// with inc0 = start / sr and dinc = (end - start) / (60 * sr^2). The phase and
+// the increment are re-anchored from this formula in double precision every
+// SEEK_BLOCK samples and only advanced in float inside a block, so the error
+// does not grow with time and any range [first_sample, first_sample + n) can
+// be rendered independently.
+#ifndef SEEK_BLOCK
+#define SEEK_BLOCK 256
+#endif
+
+// Slice size handed to one worker by audio_synth_parallel (a multiple of SEEK_BLOCK)
+#ifndef EXPORT_CHUNK
+#define EXPORT_CHUNK 65536
+#endif
+
+// frac(n * x) for n < 2^32, with the rounding error of the product folded back in
+static double sweep_frac_mul(uint64_t n, double x) {
+    double nd = (double)n;
+    double p = nd * x;
+    double e = std::fma(nd, x, -p);
+    double f = (p - std::floor(p)) + e;
+    return f - std::floor(f);
+}
+
+// frac(n * x) for any 64-bit n: split n into 32-bit halves, 2^32 * x is exact
+static double sweep_frac_mul64(uint64_t n, double x) {
+    double f = sweep_frac_mul(n >> 32, x * 4294967296.0) + sweep_frac_mul(n & 0xffffffffu, x);
+    return f - std::floor(f);
+}
+
+extern "C" void audio_synth_seek(
+    const float* starts,
+    const float* ends,
+    float* output,
+    long long first_sample,  // Absolute index of output[0]
+    int num_samples,
+    float sample_rate
+) {
+    const int NUM_VEC = (NUM_OSC + simd::kWidth - 1) / simd::kWidth;
+    const int LANES = NUM_VEC * simd::kWidth;
+    double inc0[LANES], dinc[LANES];
+    alignas(64) float slope_f[LANES];
+    for (int osc = 0; osc < LANES; ++osc) {
+        double sr = sample_rate;
+        inc0[osc] = osc < NUM_OSC ? starts[osc] / sr : 0.0;
+        dinc[osc] = osc < NUM_OSC ? (ends[osc] - starts[osc]) / (60.0 * sr * sr) : 0.0;
+        slope_f[osc] = (float)dinc[osc];
+    }
+    simd::vfloat slope[NUM_VEC];
+    for (int v = 0; v < NUM_VEC; ++v) slope[v] = simd::load(slope_f + v * simd::kWidth);
+
+    const simd::vfloat gain = simd::set1(0.06f);
+    alignas(64) float phase_f[LANES], base_f[LANES];
+    simd::vfloat phase[NUM_VEC], base[NUM_VEC];
+
+    int done = 0;
+    while (done < num_samples) {
+        // Blocks start on absolute multiples of SEEK_BLOCK. A range that begins
+        // inside a block advances the phase from the block start without
+        // output, so it is bit-identical to the same samples of a longer render.
+        const uint64_t pos = (uint64_t)(first_sample + done);
+        const uint64_t i0 = pos - pos % SEEK_BLOCK;
+        const int skip = (int)(pos - i0);
+        const int len = std::min(num_samples - done, SEEK_BLOCK - skip);
+
+        // Phase before sample i0 and increment at i0, both wrapped to [0, 1)
+        const uint64_t tri = (i0 & 1) ? i0 * ((i0 - 1) / 2) : (i0 / 2) * (i0 - 1);  // i0 * (i0 - 1) / 2
+        for (int osc = 0; osc < LANES; ++osc) {
+            double ph = sweep_frac_mul64(i0, inc0[osc]) + sweep_frac_mul64(tri, dinc[osc]);
+            double inc = inc0[osc] + sweep_frac_mul64(i0, dinc[osc]);
+            phase_f[osc] = (float)(ph - std::floor(ph));
+            base_f[osc] = (float)(inc - std::floor(inc));
+        }
+        for (int v = 0; v < NUM_VEC; ++v) {
+            phase[v] = simd::load(phase_f + v * simd::kWidth);
+            base[v] = simd::load(base_f + v * simd::kWidth);
         }
 
-        output[i] = mix;
+        for (int j = 0; j < skip; ++j) {
+            const simd::vfloat n = simd::set1((float)j);
+            for (int v = 0; v < NUM_VEC; ++v) {
+                phase[v] += simd::fmadd(slope[v], n, base[v]);
+                phase[v] -= simd::floor(phase[v]);
+            }
+        }
+        for (int j = skip; j < skip + len; ++j) {
+            const simd::vfloat n = simd::set1((float)j);
+            simd::vfloat mix = simd::zero();
+            for (int v = 0; v < NUM_VEC; ++v) {
+                phase[v] += simd::fmadd(slope[v], n, base[v]);
+                phase[v] -= simd::floor(phase[v]);
+                mix = simd::fmadd(simd::sin_turns(phase[v]), gain, mix);
+            }
+            output[done + j - skip] = simd::hsum(mix);
+        }
+        done += len;
     }
 }
-}
 
-// Note: For better performance, use ap_fixed<16,1> for phases/freq, and LUT or CORDIC for sin instead of sinf().
\ No newline at end of file
+// Time-sliced export: renders output[0, num_samples) of the sweep starting at
+// first_sample on num_threads workers (0 = all hardware threads). Workers pull
+// EXPORT_CHUNK slices from a shared counter and render them with
+// audio_synth_seek; the result does not depend on the thread count.
+extern "C" void audio_synth_parallel(
+    const float* starts,
+    const float* ends,
+    float* output,
+    long long first_sample,
+    long long num_samples,
+    float sample_rate,
+    int num_threads
+) {
+    if (num_threads <= 0) num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const long long num_chunks = (num_samples + EXPORT_CHUNK - 1) / EXPORT_CHUNK;
+    num_threads = (int)std::min<long long>(num_threads, std::max(1LL, num_chunks));
+
+    std::atomic<long long> next_chunk(0);
+    auto worker = [&]() {
+        for (long long c = next_chunk++; c < num_chunks; c = next_chunk++) {
+            long long offset = c * EXPORT_CHUNK;
+            int len = (int)std::min<long long>(EXPORT_CHUNK, num_samples - offset);
+            audio_synth_seek(starts, ends, output + offset, first_sample + offset, len, sample_rate);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < num_threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& th : pool) th.join();
+}
+#endif
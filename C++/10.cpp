@@ -1,4 +1,8 @@
 #include <hls_stream.h>  // For dataflow
+#include <cstdint>
+#include <cstdlib>
+
+#include "dsp/sine.h"
 
 typedef float data_t;  // Fixed-point or float for DSP
 
@@ -11,15 +15,36 @@ extern "C" void fm_synth_top(hls::stream<data_t>& in_stream, hls::stream<data_t>
     const int num_osc = 8;
     const float sample_rate = 44100.0f;
     const float mod_depth = 1.0f / (8 * 4);
-    float base_freq = 47.0f + (rand() % 100) / 100.0f;  // Pseudo-random
+    const float lfo_choices[3] = {3.14f * 0.5f, 3.14f * 1.0f, 3.14f * 2.0f};
+
+    // Base and LFO frequencies are drawn once, on the first call, as 9.cpp
+    // draws them once per render
+    static bool drawn = false;
+    static float base_freq;
+    static float lfo_freq[num_osc];
+    if (!drawn) {
+        base_freq = 47.0f + (rand() % 100) / 100.0f;  // Pseudo-random in [47, 48)
+        for (int osc = 0; osc < num_osc; ++osc) {
+            lfo_freq[osc] = lfo_choices[rand() % 3];  // One of [1.57, 3.14, 6.28]
+        }
+        drawn = true;
+    }
+
+    // 32-bit phases, 2^32 per turn (dsp/sine.h)
+    static uint32_t phase[num_osc] = {0};
+    static uint32_t lfo_phase[num_osc] = {0};
 
     data_t mixed = 0.0f;
     for (int osc = 0; osc < num_osc; ++osc) {
         #pragma HLS UNROLL  // Parallelize oscillators
-        float lfo_freq = 3.14159f * (0.5f + rand() % 2);  // Choose from [1.57, 3.14, 6.28]
-        // LFO and phase accumulation logic here (cumulative sin for FM)
-        // ... (integrate modulated_freq over time)
-        data_t osc_out = sin(phase);  // Simplified
+        // LFO and phase accumulation (cumulative sin for FM): the LFO bends
+        // the frequency by up to mod_depth Hz, integrated into the phase
+        // (9.cpp's fm_phase_inc)
+        float lfo = sine::Default::sin(lfo_phase[osc]);
+        lfo_phase[osc] += sine::phase_of(lfo_freq[osc] / sample_rate);
+        float modulated_freq = base_freq + mod_depth * lfo;
+        data_t osc_out = sine::Default::sin(phase[osc]);
+        phase[osc] += sine::phase_of(modulated_freq / sample_rate);
         mixed += osc_out;
     }
     mixed /= num_osc;
@@ -1,8 +1,9 @@
 // C++ HLS code for audio synthesis on Alinx FPGA
 // Implements approximation of SuperCollider: Mix.fill(8, {SinOsc.ar(rrand(20,200),0,SinOsc.ar([1,2,4,8].choose*0.01,0,1/8/4,0.01))})
-// Uses wavetable lookup for sine waves
+// Sines through SINE_POLICY (dsp/sine.h) on 32-bit phase accumulators: an
+// on-chip interpolated ROM computed at compile time by default, where this
+// used to read a host-filled wavetable in DDR
 // Frequencies are hardcoded to simulate random
-// Assumes external memory for wavetable, initialized by host (e.g., ARM on Zynq)
 // Output is stereo via hls_stream, to be connected to I2S in top-level HDL
 // Sample rate assumed 44100 Hz
 
@@ -10,29 +11,38 @@
 #include <ap_int.h>
 #include <hls_math.h>
 
+#include "dsp/sine.h"
+
 #define NUM_OSC 8
-#define TABLE_SIZE 16384
-#define SAMPLE_RATE 44100.0f
+#define SAMPLE_RATE 44100.0
 
 // Top-level function
 void audio_synth(
     hls::stream<ap_int<24>>& audio_left,
     hls::stream<ap_int<24>>& audio_right,
-    float* wavetable,  // m_axi to DDR
     ap_uint<1> arm_ok  // Control signal
 ) {
-#pragma HLS INTERFACE m_axi port=wavetable offset=slave bundle=gmem latency=30
 #pragma HLS INTERFACE axis port=audio_left
 #pragma HLS INTERFACE axis port=audio_right
 #pragma HLS INTERFACE ap_ctrl_hs port=return
 #pragma HLS INTERFACE ap_none port=arm_ok
 
     static bool initialized = false;
-    static float phase_main[NUM_OSC];
-    static float phase_mod[NUM_OSC];
+    static uint32_t phase_main[NUM_OSC];
+    static uint32_t phase_mod[NUM_OSC];
 
-    const float base_freq[NUM_OSC] = {30.0f, 55.0f, 80.0f, 110.0f, 140.0f, 165.0f, 185.0f, 195.0f};
-    const float mod_freq[NUM_OSC] = {0.01f, 0.04f, 0.02f, 0.08f, 0.01f, 0.02f, 0.04f, 0.08f};
+    // Increments of 30, 55, 80, 110, 140, 165, 185, 195 Hz and of the
+    // 0.01 to 0.08 Hz amplitude LFOs
+    const uint32_t inc_main[NUM_OSC] = {
+        sine::phase_inc(30.0, SAMPLE_RATE), sine::phase_inc(55.0, SAMPLE_RATE),
+        sine::phase_inc(80.0, SAMPLE_RATE), sine::phase_inc(110.0, SAMPLE_RATE),
+        sine::phase_inc(140.0, SAMPLE_RATE), sine::phase_inc(165.0, SAMPLE_RATE),
+        sine::phase_inc(185.0, SAMPLE_RATE), sine::phase_inc(195.0, SAMPLE_RATE)};
+    const uint32_t inc_mod[NUM_OSC] = {
+        sine::phase_inc(0.01, SAMPLE_RATE), sine::phase_inc(0.04, SAMPLE_RATE),
+        sine::phase_inc(0.02, SAMPLE_RATE), sine::phase_inc(0.08, SAMPLE_RATE),
+        sine::phase_inc(0.01, SAMPLE_RATE), sine::phase_inc(0.02, SAMPLE_RATE),
+        sine::phase_inc(0.04, SAMPLE_RATE), sine::phase_inc(0.08, SAMPLE_RATE)};
     const float amp_scale = 1.0f / 8.0f / 4.0f;
     const float amp_offset = 0.01f;
 
@@ -40,8 +50,8 @@ void audio_synth(
         if (!initialized) {
             // Initialize phases
             for (int i = 0; i < NUM_OSC; ++i) {
-                phase_main[i] = 0.0f;
-                phase_mod[i] = 0.0f;
+                phase_main[i] = 0;
+                phase_mod[i] = 0;
             }
             initialized = true;
         } else {
@@ -50,19 +60,13 @@ void audio_synth(
 
             loop_osc: for (int i = 0; i < NUM_OSC; ++i) {
 #pragma HLS UNROLL
-                // Main oscillator
-                float incr_main = base_freq[i] / SAMPLE_RATE;
-                phase_main[i] += incr_main;
-                if (phase_main[i] >= 1.0f) phase_main[i] -= 1.0f;  // Instead of fmodf for efficiency
-                int idx_main = (int)(phase_main[i] * TABLE_SIZE);
-                float osc = wavetable[idx_main];
+                // Main oscillator (the phase wraps on overflow)
+                phase_main[i] += inc_main[i];
+                float osc = sine::Default::sin(phase_main[i]);
 
                 // Mod oscillator for amplitude
-                float incr_mod = mod_freq[i] / SAMPLE_RATE;
-                phase_mod[i] += incr_mod;
-                if (phase_mod[i] >= 1.0f) phase_mod[i] -= 1.0f;
-                int idx_mod = (int)(phase_mod[i] * TABLE_SIZE);
-                float mod_amp = wavetable[idx_mod] * amp_scale + amp_offset;
+                phase_mod[i] += inc_mod[i];
+                float mod_amp = sine::Default::sin(phase_mod[i]) * amp_scale + amp_offset;
 
                 // Accumulate
                 sum += osc * mod_amp;
@@ -75,4 +79,5 @@ void audio_synth(
             audio_left.write(out_sample);
             audio_right.write(out_sample);
         }
-    }
\ No newline at end of file
+    }
+}
@@ -2,46 +2,74 @@
 #include <math.h>
 #include <ap_int.h>  // For LFSR if needed, but using uint32_t
 
+#include "dsp/delay.h"
+#include "dsp/sine.h"
+
+#ifndef __SYNTHESIS__
+#include <type_traits>
+#include "dsp/simd.h"
+#endif
+
 #define SAMPLE_RATE 44100.0f
 #define PI 3.1415926535f
-#define TABLE_SIZE 16384
-
-// Assume sine_table is initialized in a separate init function or ROM
-// For example:
-// void init_sine_table(float sine_table[TABLE_SIZE]) {
-//     for(int i = 0; i < TABLE_SIZE; i++) {
-//         sine_table[i] = sinf(2 * PI * i / TABLE_SIZE);
-//     }
-// }
-extern float sine_table[TABLE_SIZE];
-
-inline float sin_lut(float phase) {
-    int idx = (int)(fmodf(phase, 1.0f) * TABLE_SIZE);
-    if (idx < 0) idx += TABLE_SIZE;
-    return sine_table[idx];
+
+// Storage codec of the FreeVerb delay lines (dsp/delay.h). delay::Q2_13
+// holds them in 82 KB where the default delay::F32 takes 165 KB, but the
+// fixed gain leaves the comb samples near 0.01, a few bits of Q2.13: the
+// output moves by up to 1.7e-3, and the host block path is slower on them
+// (bench/freeverb_bench.cpp). delay::BF16 also halves them; the
+// block path takes F32 and Q2_13 lines only, so BF16 runs per frame.
+#ifndef FREEVERB_STORE
+#define FREEVERB_STORE delay::F32
+#endif
+
+// Oscillator phases are 32-bit (2^32 per turn, wrapping on overflow) and go
+// through SINE_POLICY (dsp/sine.h), a compile-time ROM by default. A
+// carrier swept below 0 Hz by the FM steps backwards through the wrap.
+inline uint32_t phase_step(float freq) { return sine::phase_of(freq / SAMPLE_RATE); }
+
+// Low-frequency noise approximation: LFSR white noise through a 1-pole lowpass.
+// The state lives in a struct so block renderers can keep it in registers; the
+// per-sample helpers below all share one instance, as the original function
+// statics did (all rates feed the same filter state).
+struct LFNoise {
+    uint32_t lfsr;  // Non-zero seed
+    float state;
+
+    LFNoise() : lfsr(0xACE1u), state(0.0f) {}
+
+    // Lowpass coefficient for a given rate; constant per call site, so block
+    // renderers compute it once instead of calling expf every sample.
+    static float coeff(float rate) {
+        return expf(-2 * PI * rate / SAMPLE_RATE);
+    }
+
+    inline float white() {
+        uint32_t bit = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1u;
+        lfsr = (lfsr >> 1) | (bit << 31);
+        return 2.0f * (float)bit - 1.0f;
+    }
+
+    inline float next(float lp_coeff) {
+        float white_val = white();
+        float noise_out = lp_coeff * state + (1 - lp_coeff) * white_val;
+        state = noise_out;
+        return noise_out;
+    }
+};
+
+inline LFNoise& shared_lfnoise() {
+    static LFNoise noise;
+    return noise;
 }
 
 // Simple LFSR for white noise
 inline float get_white_noise() {
-    static uint32_t lfsr = 0xACE1u;  // Non-zero seed
-    uint32_t bit = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1u;
-    lfsr = (lfsr >> 1) | (bit << 31);
-    return 2.0f * (float)bit - 1.0f;
+    return shared_lfnoise().white();
 }
 
-// Low-frequency noise approximation using 1-pole lowpass on white noise
 float get_lfnoise(float rate) {
-    static float noise_state1 = 0.0f;
-    static float noise_state2 = 0.0f;  // Separate states for different rates
-
-    float lp_coeff = expf(-2 * PI * rate / SAMPLE_RATE);
-    float white = get_white_noise();
-
-    // For LFNoise2 (use noise_state1), approximate
-    float noise_out = lp_coeff * noise_state1 + (1 - lp_coeff) * white;
-    noise_state1 = noise_out;
-
-    return noise_out;
+    return shared_lfnoise().next(LFNoise::coeff(rate));
 }
 
 // Rational tanh approximation
@@ -52,248 +80,686 @@ inline float fast_tanh(float x) {
     return x * (27.0f + x2) / (27.0f + 9.0f * x2);
 }
 
+// Coefficient updates run at control rate: parameter setters only compare and
+// mark the state dirty, and every CONTROL_BLOCK samples a dirty filter/reverb
+// recomputes its target coefficients once and ramps to them linearly over the
+// next block. Unchanged parameters cost nothing. A period of 1 recomputes on
+// every changed sample, which is the original per-sample behaviour.
+#ifndef CONTROL_BLOCK
+#define CONTROL_BLOCK 32
+#endif
+
+struct ControlRate {
+    int period;     // Samples between coefficient updates
+    int countdown;  // Samples left until the next update
+    bool dirty;     // Parameters changed since the last update
+    bool primed;    // Coefficients have been set from real parameters once
+
+    ControlRate() : period(CONTROL_BLOCK), countdown(0), dirty(false), primed(false) {}
+
+    void setPeriod(int samples) {
+        period = samples < 1 ? 1 : samples;
+        countdown = 0;
+    }
+};
+
 // Biquad filter for RLPF (lowpass resonant)
 class BiquadLPF {
 public:
-    float a0, a1, a2, b1, b2;
+    float a0, a1, a2, b1, b2;   // Coefficients in use
+    float da0, db1, db2;        // Per-sample ramp increments
+    float t_a0, t_b1, t_b2;     // Targets for the current ramp
     float z1, z2;
     float Fc, Q;
+    ControlRate ctl;
 
     BiquadLPF() : z1(0.0f), z2(0.0f), Fc(0.5f), Q(0.707f) {
         update_coeffs();
+        snap_coeffs();
     }
 
+    void setControlRate(int samples) { ctl.setPeriod(samples); }
+
     void setFcQ(float fc, float q) {
-        Fc = fc / SAMPLE_RATE;
+        float fc_norm = fc / SAMPLE_RATE;
+        if (ctl.primed && fc_norm == Fc && q == Q) return;
+        Fc = fc_norm;
         Q = q;
-        update_coeffs();
+        if (!ctl.primed) {
+            // First real parameters: apply immediately instead of ramping from
+            // the constructor defaults.
+            update_coeffs();
+            snap_coeffs();
+            ctl.primed = true;
+            ctl.dirty = false;
+        } else {
+            ctl.dirty = true;
+        }
     }
 
+    // Target coefficients for the current Fc/Q (the only tanf in the filter)
     void update_coeffs() {
         float K = tanf(PI * Fc);
         float norm = 1.0f / (1.0f + K / Q + K * K);
-        a0 = K * K * norm;
+        t_a0 = K * K * norm;
+        t_b1 = 2.0f * (K * K - 1.0f) * norm;
+        t_b2 = (1.0f - K / Q + K * K) * norm;
+    }
+
+    void snap_coeffs() {
+        a0 = t_a0;
         a1 = 2.0f * a0;
         a2 = a0;
-        b1 = 2.0f * (K * K - 1.0f) * norm;
-        b2 = (1.0f - K / Q + K * K) * norm;
+        b1 = t_b1;
+        b2 = t_b2;
+        da0 = db1 = db2 = 0.0f;
+    }
+
+    inline void control_update() {
+        ctl.countdown = ctl.period;
+        if (ctl.dirty) {
+            update_coeffs();
+            ctl.dirty = false;
+            if (ctl.period > 1) {
+                float inv = 1.0f / ctl.period;
+                da0 = (t_a0 - a0) * inv;
+                db1 = (t_b1 - b1) * inv;
+                db2 = (t_b2 - b2) * inv;
+                return;
+            }
+        }
+        // Previous ramp finished (or immediate update): land exactly on target
+        snap_coeffs();
     }
 
     float process(float in) {
+        if (ctl.countdown == 0) control_update();
+        --ctl.countdown;
+
         float out = in * a0 + z1;
         z1 = in * a1 + z2 - b1 * out;
         z2 = in * a2 - b2 * out;
+
+        a0 += da0;
+        a1 = 2.0f * a0;
+        a2 = a0;
+        b1 += db1;
+        b2 += db2;
         return out;
     }
 };
 
-// Simple FreeVerb approximation (simplified to one comb per channel for brevity; full impl would use 8 combs + 4 allpasses)
-class SimpleFreeVerb {
+// Freeverb (Jezar at Dreampoint): per channel, 8 lowpass-feedback combs in
+// parallel into 4 allpasses in series, with the right channel's lines 23
+// samples longer for stereo spread. Parameters map as in SuperCollider's
+// FreeVerb: room sets the comb feedback (0.7 + 0.28 * room), damp the comb
+// lowpass (0.4 * damp), and mix crossfades dry to wet.
+// process(left, right) runs one frame; it is the path synthesis sees, and on
+// the host it costs about ten times SimpleFreeVerb's frame. On the host,
+// process(left, right, n) runs blocks of simd::kWidth frames along the
+// vector lanes. Every comb is longer than a block, so a block's delayed
+// samples are all written already and load as one vector per comb. While
+// the coefficients hold, the comb lowpass runs along the lanes as a scan;
+// during a ramp the block is transposed to one vector per frame, so the
+// recursion can take per-frame coefficients across the 16 combs, and back.
+// The allpasses, also longer than a block, run along the frames. The
+// output matches the per-frame path to float rounding. With AVX-512 a frame
+// costs about what SimpleFreeVerb's did, 0.85-0.9x its speed; with 8 or 4
+// lanes 2-3.5x its cost (bench/freeverb_bench.cpp). The lines are
+// delay::FixedDelay with a GUARD-sample tail, so block loads and stores
+// never wrap.
+static const int FREEVERB_COMB_TUNING[8] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+static const int FREEVERB_ALLPASS_TUNING[4] = {556, 441, 341, 225};
+static const float FREEVERB_FIXED_GAIN = 0.015f;
+
+template <typename Codec = FREEVERB_STORE>
+class FreeVerb {
 public:
-    static const int DELAY_LEN = 1000;  // Approx for roomsize
-    float delay_line[2][DELAY_LEN];  // Left and right
-    int delay_ptr[2];
-    float room_size, damp, mix;
-    float comb_coeff, damp_coeff;
-
-    SimpleFreeVerb() : room_size(0.6f), damp(0.3f), mix(0.4f) {
-        comb_coeff = room_size;
-        damp_coeff = 1.0f - damp;
-        delay_ptr[0] = delay_ptr[1] = 0;
-        for (int ch = 0; ch < 2; ++ch) {
-            for (int i = 0; i < DELAY_LEN; ++i) {
-                delay_line[ch][i] = 0.0f;
+    static const int NUM_COMBS = 8;                 // Per channel
+    static const int NUM_ALLPASSES = 4;             // Per channel
+    static const int COMB_LANES = 2 * NUM_COMBS;    // Left combs, then right
+    static const int STEREO_SPREAD = 23;
+    static const int GUARD = 16;                    // Widest simd::kWidth
+    typedef delay::FixedDelay<1617 + STEREO_SPREAD, Codec, GUARD> CombLine;    // 2048 samples
+    typedef delay::FixedDelay<556 + STEREO_SPREAD, Codec, GUARD> AllpassLine;  // 1024 samples
+
+    CombLine comb_line[COMB_LANES];
+    AllpassLine allpass_line[2][NUM_ALLPASSES];
+    alignas(64) float comb_state[COMB_LANES];       // Comb lowpass memories
+    int comb_delay[COMB_LANES];
+    int allpass_delay[2][NUM_ALLPASSES];
+    float room_size, damp, mix;                     // Parameters as last set
+    float feedback, damp1, wet;                     // Coefficients in use
+    float d_feedback, d_damp1, d_wet;               // Per-sample ramp increments
+    ControlRate ctl;
+
+    FreeVerb() : room_size(0.6f), damp(0.3f), mix(0.4f) {
+        for (int i = 0; i < COMB_LANES; i++) {
+            comb_state[i] = 0.0f;
+            comb_delay[i] = FREEVERB_COMB_TUNING[i % NUM_COMBS] + (i < NUM_COMBS ? 0 : STEREO_SPREAD);
+        }
+        for (int ch = 0; ch < 2; ch++) {
+            for (int a = 0; a < NUM_ALLPASSES; a++) {
+                allpass_delay[ch][a] = FREEVERB_ALLPASS_TUNING[a] + ch * STEREO_SPREAD;
             }
         }
+        snap_coeffs();
     }
 
+    void setControlRate(int samples) { ctl.setPeriod(samples); }
+
     void setParams(float m, float r, float d) {
+        if (ctl.primed && m == mix && r == room_size && d == damp) return;
         mix = m;
         room_size = r;
         damp = d;
-        comb_coeff = room_size;
-        damp_coeff = 1.0f - damp;
+        if (!ctl.primed) {
+            // First real parameters: apply immediately instead of ramping from
+            // the constructor defaults, as BiquadLPF::setFcQ does.
+            snap_coeffs();
+            ctl.primed = true;
+            ctl.dirty = false;
+        } else {
+            ctl.dirty = true;
+        }
+    }
+
+    void snap_coeffs() {
+        feedback = 0.7f + 0.28f * room_size;
+        damp1 = 0.4f * damp;
+        wet = mix;
+        d_feedback = d_damp1 = d_wet = 0.0f;
+    }
+
+    inline void control_update() {
+        ctl.countdown = ctl.period;
+        if (ctl.dirty) {
+            ctl.dirty = false;
+            if (ctl.period > 1) {
+                float inv = 1.0f / ctl.period;
+                d_feedback = ((0.7f + 0.28f * room_size) - feedback) * inv;
+                d_damp1 = (0.4f * damp - damp1) * inv;
+                d_wet = (mix - wet) * inv;
+                return;
+            }
+        }
+        snap_coeffs();
     }
 
     void process(float& left, float& right) {
-        // Simple mono to stereo comb reverb
-        float input = (left + right) * 0.5f;
-
-        // Left channel comb
-        float delayed = delay_line[0][delay_ptr[0]];
-        float filtered = damp_coeff * delayed + (1.0f - damp_coeff) * delay_line[0][(delay_ptr[0] + DELAY_LEN/2) % DELAY_LEN];
-        float feedback = input + comb_coeff * filtered;
-        delay_line[0][delay_ptr[0]] = feedback;
-        delay_ptr[0] = (delay_ptr[0] + 1) % DELAY_LEN;
-        float reverb_left = delayed;
-
-        // Right channel (stereo spread)
-        delayed = delay_line[1][delay_ptr[1]];
-        filtered = damp_coeff * delayed + (1.0f - damp_coeff) * delay_line[1][(delay_ptr[1] + DELAY_LEN/2) % DELAY_LEN];
-        feedback = input + comb_coeff * filtered;
-        delay_line[1][delay_ptr[1]] = feedback;
-        delay_ptr[1] = (delay_ptr[1] + 1) % DELAY_LEN;
-        float reverb_right = delayed;
-
-        left = left * (1.0f - mix) + reverb_left * mix;
-        right = right * (1.0f - mix) + reverb_right * mix;
+        if (ctl.countdown == 0) control_update();
+        --ctl.countdown;
+
+        float input = (left + right) * FREEVERB_FIXED_GAIN;
+        float out[2] = {0.0f, 0.0f};
+        for (int i = 0; i < COMB_LANES; i++) {
+            float delayed = comb_line[i].read(comb_delay[i]);
+            comb_state[i] = comb_state[i] * damp1 + delayed * (1.0f - damp1);
+            comb_line[i].write(input + comb_state[i] * feedback);
+            out[i / NUM_COMBS] += delayed;
+        }
+        for (int ch = 0; ch < 2; ch++) {
+            for (int a = 0; a < NUM_ALLPASSES; a++) {
+                float delayed = allpass_line[ch][a].read(allpass_delay[ch][a]);
+                allpass_line[ch][a].write(out[ch] + delayed * 0.5f);
+                out[ch] = delayed - out[ch];
+            }
+        }
+
+        left = left * (1.0f - wet) + out[0] * wet;
+        right = right * (1.0f - wet) + out[1] * wet;
+
+        feedback += d_feedback;
+        damp1 += d_damp1;
+        wet += d_wet;
+    }
+
+    // n frames in place; the output of n calls of process(left, right), to
+    // float rounding
+    void process(float* left, float* right, int n) {
+#ifndef __SYNTHESIS__
+        if constexpr (std::is_same<Codec, delay::F32>::value || std::is_same<Codec, delay::Q2_13>::value) {
+            const int W = simd::kWidth;
+            int i = 0;
+            for (; i < n && (comb_line[0].pos() & (W - 1)) != 0; i++) process(left[i], right[i]);
+            for (; i + W <= n; i += W) process_block(left + i, right + i);
+            for (; i < n; i++) process(left[i], right[i]);
+            return;
+        }
+#endif
+        for (int i = 0; i < n; i++) process(left[i], right[i]);
+    }
+
+private:
+#ifndef __SYNTHESIS__
+    // kWidth samples of a line from or to its storage, with the codec's
+    // arithmetic (Q2_13 is x * 2^13, rounded to nearest even)
+    static simd::vfloat load_run(const float* p) { return simd::loadu(p); }
+    static simd::vfloat load_run(const int16_t* p) { return simd::load_i16(p) * simd::set1(1.0f / 8192.0f); }
+    static void store_run(float* p, simd::vfloat x) { simd::store(p, x); }
+    static void store_run(int16_t* p, simd::vfloat x) { simd::store_i16(p, x * simd::set1(8192.0f)); }
+
+    // simd::kWidth frames from a block boundary (the lines' pos() a multiple
+    // of kWidth)
+    void process_block(float* left, float* right) {
+        const int W = simd::kWidth;
+        alignas(64) float input[W], fb[W], d1[W], wt[W];
+        simd::store(input, (simd::loadu(left) + simd::loadu(right)) * simd::set1(FREEVERB_FIXED_GAIN));
+        // Coefficients per frame, unless they hold over the block: no ramp
+        // running, and no update due or only one that would snap them to the
+        // values they already have
+        const bool held = (ctl.countdown >= W || !ctl.dirty) && d_feedback == 0.0f && d_damp1 == 0.0f && d_wet == 0.0f;
+        if (held) {
+            int frames = W;
+            while (frames > ctl.countdown) {
+                frames -= ctl.countdown;
+                ctl.countdown = ctl.period;
+            }
+            ctl.countdown -= frames;
+        } else {
+            for (int s = 0; s < W; s++) {
+                if (ctl.countdown == 0) control_update();
+                --ctl.countdown;
+                fb[s] = feedback;
+                d1[s] = damp1;
+                wt[s] = wet;
+                feedback += d_feedback;
+                damp1 += d_damp1;
+                wet += d_wet;
+            }
+        }
+
+        simd::vfloat out[2] = {simd::zero(), simd::zero()};
+        if (held) {
+            // Each comb's W delayed samples stay in one vector, and its
+            // lowpass state[s] = a state[s - 1] + b delayed[s] runs along the
+            // lanes as a scan: log2(W) shift-and-add steps, then the state
+            // carried in from the last block times a^(s + 1). The sums round
+            // differently from the frame loop's, by about 2e-8 on the output.
+            alignas(64) float pw[W];
+            pw[0] = damp1;
+            for (int s = 1; s < W; s++) pw[s] = pw[s - 1] * damp1;
+            const simd::vfloat in = simd::load(input), carry = simd::load(pw);
+            const simd::vfloat a1 = simd::set1(pw[0]), a2 = simd::set1(pw[W > 1 ? 1 : 0]);
+            const simd::vfloat a4 = simd::set1(pw[W > 3 ? 3 : 0]), a8 = simd::set1(pw[W > 7 ? 7 : 0]);
+            const simd::vfloat b = simd::set1(1.0f - damp1), f = simd::set1(feedback);
+            for (int j = 0; j < COMB_LANES; j++) {
+                typename CombLine::storage_type* head = comb_line[j].head();
+                const simd::vfloat r = load_run(comb_line[j].tap(comb_delay[j]));
+                out[j / NUM_COMBS] += r;
+                simd::vfloat y = r * b;
+                y = simd::fmadd(simd::shift_up<1>(y), a1, y);
+                y = simd::fmadd(simd::shift_up<2>(y), a2, y);
+                y = simd::fmadd(simd::shift_up<4>(y), a4, y);
+                y = simd::fmadd(simd::shift_up<8>(y), a8, y);
+                y = simd::fmadd(carry, simd::set1(comb_state[j]), y);
+                comb_state[j] = simd::last(y);
+                store_run(head, simd::fmadd(y, f, in));
+            }
+            for (int j = 0; j < COMB_LANES; j++) comb_line[j].commit(W);
+        } else {
+            // r[j] holds comb g + j's W delayed samples, and after the transpose
+            // the W combs at frame s in r[s]. Each line's head is taken before
+            // its vector stores and committed after them all: the stores may
+            // alias anything, so a position read between them is read again
+            // from memory (about 2 ns a frame more on AVX-512).
+            for (int g = 0; g < COMB_LANES; g += W) {
+                simd::vfloat r[W];
+                typename CombLine::storage_type* head[W];
+                for (int j = 0; j < W; j++) {
+                    head[j] = comb_line[g + j].head();
+                    r[j] = load_run(comb_line[g + j].tap(comb_delay[g + j]));
+                    out[(g + j) / NUM_COMBS] += r[j];
+                }
+                simd::transpose(r);
+                simd::vfloat state = simd::load(&comb_state[g]);
+                for (int s = 0; s < W; s++) {
+                    state = simd::fmadd(state, simd::set1(d1[s]), r[s] * simd::set1(1.0f - d1[s]));
+                    r[s] = simd::fmadd(state, simd::set1(fb[s]), simd::set1(input[s]));
+                }
+                simd::store(&comb_state[g], state);
+                simd::transpose(r);
+                for (int j = 0; j < W; j++) store_run(head[j], r[j]);
+                for (int j = 0; j < W; j++) comb_line[g + j].commit(W);
+            }
+        }
+
+        for (int ch = 0; ch < 2; ch++) {
+            for (int a = 0; a < NUM_ALLPASSES; a++) {
+                AllpassLine& line = allpass_line[ch][a];
+                typename AllpassLine::storage_type* head = line.head();
+                simd::vfloat delayed = load_run(line.tap(allpass_delay[ch][a]));
+                store_run(head, simd::fmadd(delayed, simd::set1(0.5f), out[ch]));
+                out[ch] = delayed - out[ch];
+            }
+        }
+        for (int ch = 0; ch < 2; ch++) {
+            for (int a = 0; a < NUM_ALLPASSES; a++) allpass_line[ch][a].commit(W);
+        }
+
+        const simd::vfloat w = held ? simd::set1(wet) : simd::load(wt);
+        const simd::vfloat dry = simd::set1(1.0f) - w;
+        simd::storeu(left, simd::fmadd(simd::loadu(left), dry, out[0] * w));
+        simd::storeu(right, simd::fmadd(simd::loadu(right), dry, out[1] * w));
     }
+#endif
 };
 
-// Top-level HLS function for first synth (processes one stereo sample per call)
-void fm_synth1(hls::stream<float>& out_left, hls::stream<float>& out_right) {
-#pragma HLS INTERFACE axis port=out_left
-#pragma HLS INTERFACE axis port=out_right
-#pragma HLS INTERFACE s_axilite port=return
+// Block renderers for the three patches. process() runs the whole chain
+// (lfnoise -> FM -> RLPF -> tanh -> FreeVerb) over nframes with the oscillator,
+// noise and filter state held in locals, and hoists everything that is constant
+// per patch (noise coefficients, Q, reverb params) out of the frame loop.
+// The output is that of calling the matching fm_synthN top function nframes
+// times, to FreeVerb's block rounding. Each instance owns its noise source
+// unless one is passed in; the top functions pass shared_lfnoise() to keep
+// their original behaviour.
+class FmSynth1 {
+public:
+    FmSynth1() : shared_noise(0), mod_phase(0), sub_phase(0) {
+        carrier_phases[0] = carrier_phases[1] = carrier_phases[2] = 0;
+    }
+    explicit FmSynth1(LFNoise& noise) : FmSynth1() { shared_noise = &noise; }
 
-    static float mod_phase = 0.0f;
-    static float sub_phase = 0.0f;
-    static float carrier_phases[3] = {0.0f, 0.0f, 0.0f};
-    static BiquadLPF lpf;
-    static SimpleFreeVerb reverb;
-
-    // Get slow-varying parameters (update every sample for simplicity)
-    float noise_modfreq = get_lfnoise(0.2f);
-    float modFreq = ((noise_modfreq + 1.0f) / 2.0f * 7.0f + 1.0f) * 50.0f;
-
-    float noise_modindex = get_lfnoise(0.1f);
-    float modIndex = ((noise_modindex + 1.0f) / 2.0f * 60.0f + 20.0f);
-
-    float noise_cutoff = get_lfnoise(0.1f);
-    float cutoff = ((noise_cutoff + 1.0f) / 2.0f * 1200.0f + 300.0f);
-    float rq = 0.3f;
-    float Q = 1.0f / rq;
-    lpf.setFcQ(cutoff, Q);
-
-    // Modulator (shared)
-    float mod_incr = modFreq / SAMPLE_RATE;
-    float mod = sin_lut(mod_phase) * modIndex;
-    mod_phase = fmodf(mod_phase + mod_incr, 1.0f);
-
-    // Carriers
-    float carriers[3] = {60.0f, 62.0f, 90.0f};
-    float drone = 0.0f;
-    for (int i = 0; i < 3; ++i) {
-        float cfreq = carriers[i] + mod;
-        float carrier_incr = cfreq / SAMPLE_RATE;
-        float carrier = sin_lut(carrier_phases[i]) * 0.1f;
-        drone += carrier;
-        carrier_phases[i] = fmodf(carrier_phases[i] + carrier_incr, 1.0f);
+    // Samples between filter/reverb coefficient updates (1 = every sample)
+    void setControlRate(int samples) {
+        lpf.setControlRate(samples);
+        reverb.setControlRate(samples);
     }
 
-    // Sub oscillator
-    float sub_incr = 30.0f / SAMPLE_RATE;
-    float sub = sin_lut(sub_phase) * 0.1f;
-    sub_phase = fmodf(sub_phase + sub_incr, 1.0f);
+    void process(float* out_left, float* out_right, int nframes) {
+        LFNoise& noise_src = shared_noise ? *shared_noise : own_noise;
+        LFNoise noise = noise_src;
+        BiquadLPF filt = lpf;
+        uint32_t mod_ph = mod_phase;
+        uint32_t sub_ph = sub_phase;
+        uint32_t car_ph[3] = {carrier_phases[0], carrier_phases[1], carrier_phases[2]};
+
+        const float coeff_modfreq = LFNoise::coeff(0.2f);
+        const float coeff_slow = LFNoise::coeff(0.1f);
+        const float rq = 0.3f;
+        const float Q = 1.0f / rq;
+        const float carriers[3] = {60.0f, 62.0f, 90.0f};
+        const uint32_t sub_incr = phase_step(30.0f);
+        reverb.setParams(0.4f, 0.6f, 0.3f);
+
+        for (int n = 0; n < nframes; ++n) {
+            float noise_modfreq = noise.next(coeff_modfreq);
+            float modFreq = ((noise_modfreq + 1.0f) / 2.0f * 7.0f + 1.0f) * 50.0f;
+
+            float noise_modindex = noise.next(coeff_slow);
+            float modIndex = ((noise_modindex + 1.0f) / 2.0f * 60.0f + 20.0f);
+
+            float noise_cutoff = noise.next(coeff_slow);
+            float cutoff = ((noise_cutoff + 1.0f) / 2.0f * 1200.0f + 300.0f);
+            filt.setFcQ(cutoff, Q);
+
+            // Modulator (shared)
+            float mod = sine::Default::sin(mod_ph) * modIndex;
+            mod_ph += phase_step(modFreq);
+
+            // Carriers
+            float drone = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                float cfreq = carriers[i] + mod;
+                float carrier = sine::Default::sin(car_ph[i]) * 0.1f;
+                drone += carrier;
+                car_ph[i] += phase_step(cfreq);
+            }
 
-    float sig = drone + sub;
+            // Sub oscillator
+            float sub = sine::Default::sin(sub_ph) * 0.1f;
+            sub_ph += sub_incr;
 
-    // RLPF
-    sig = lpf.process(sig);
+            float sig = drone + sub;
+            sig = filt.process(sig);
+            sig = fast_tanh(sig * 5.0f) * 0.3f;
 
-    // Tanh distortion
-    sig = fast_tanh(sig * 5.0f) * 0.3f;
+            out_left[n] = sig;
+            out_right[n] = sig;
+        }
 
-    // FreeVerb (simplified)
-    float left = sig;
-    float right = sig;
-    reverb.setParams(0.4f, 0.6f, 0.3f);  // Update params
-    reverb.process(left, right);
+        reverb.process(out_left, out_right, nframes);
+        for (int n = 0; n < nframes; ++n) {
+            // Splay approx: for mono, just stereo copy with slight spread if needed
+            out_left[n] *= 0.5f;  // Splay 0.5 approx
+            out_right[n] *= 0.5f;
+        }
 
-    // Splay approx: for mono, just stereo copy with slight spread if needed
-    // Here, simple stereo same
-    out_left << left * 0.5f;  // Splay 0.5 approx
-    out_right << right * 0.5f;
-}
+        noise_src = noise;
+        lpf = filt;
+        mod_phase = mod_ph;
+        sub_phase = sub_ph;
+        for (int i = 0; i < 3; ++i) carrier_phases[i] = car_ph[i];
+    }
 
-// Similar implementations for the other two synths...
+private:
+    LFNoise own_noise;
+    LFNoise* shared_noise;
+    uint32_t mod_phase;
+    uint32_t sub_phase;
+    uint32_t carrier_phases[3];
+    BiquadLPF lpf;
+    FreeVerb<> reverb;
+};
 
-// Second synth: single carrier
-void fm_synth2(hls::stream<float>& out_left, hls::stream<float>& out_right) {
-#pragma HLS INTERFACE axis port=out_left
-#pragma HLS INTERFACE axis port=out_right
-#pragma HLS INTERFACE s_axilite port=return
+// Second patch: single carrier
+class FmSynth2 {
+public:
+    FmSynth2() : shared_noise(0), mod_phase(0), carrier_phase(0), sub_phase(0) {}
+    explicit FmSynth2(LFNoise& noise) : FmSynth2() { shared_noise = &noise; }
 
-    static float mod_phase = 0.0f;
-    static float carrier_phase = 0.0f;
-    static float sub_phase = 0.0f;
-    static BiquadLPF lpf;
-    static SimpleFreeVerb reverb;
+    // Samples between filter/reverb coefficient updates (1 = every sample)
+    void setControlRate(int samples) {
+        lpf.setControlRate(samples);
+        reverb.setControlRate(samples);
+    }
 
-    float noise_modfreq = get_lfnoise(0.2f);
-    float modFreq = ((noise_modfreq + 1.0f) / 2.0f * 5.0f + 1.0f) * 50.0f;  // range 1-6 *50
+    void process(float* out_left, float* out_right, int nframes) {
+        LFNoise& noise_src = shared_noise ? *shared_noise : own_noise;
+        LFNoise noise = noise_src;
+        BiquadLPF filt = lpf;
+        uint32_t mod_ph = mod_phase;
+        uint32_t car_ph = carrier_phase;
+        uint32_t sub_ph = sub_phase;
+
+        const float coeff_modfreq = LFNoise::coeff(0.2f);
+        const float coeff_slow = LFNoise::coeff(0.1f);
+        const float rq = 0.3f;
+        const float Q = 1.0f / rq;
+        const float carrier_freq = 70.0f;
+        const uint32_t sub_incr = phase_step(30.0f);
+        reverb.setParams(0.3f, 0.6f, 0.3f);
+
+        for (int n = 0; n < nframes; ++n) {
+            float noise_modfreq = noise.next(coeff_modfreq);
+            float modFreq = ((noise_modfreq + 1.0f) / 2.0f * 5.0f + 1.0f) * 50.0f;  // range 1-6 *50
+
+            float noise_modindex = noise.next(coeff_slow);
+            float modIndex = ((noise_modindex + 1.0f) / 2.0f * 50.0f + 10.0f);
+
+            float noise_cutoff = noise.next(coeff_slow);
+            float cutoff = ((noise_cutoff + 1.0f) / 2.0f * 1000.0f + 200.0f);
+            filt.setFcQ(cutoff, Q);
+
+            float mod = sine::Default::sin(mod_ph) * modIndex;
+            mod_ph += phase_step(modFreq);
+
+            float cfreq = carrier_freq + mod;
+            float tone = sine::Default::sin(car_ph) * 0.2f;
+            car_ph += phase_step(cfreq);
+
+            float sub = sine::Default::sin(sub_ph) * 0.1f;
+            sub_ph += sub_incr;
+
+            float sig = tone + sub;
+            sig = filt.process(sig);
+            sig = fast_tanh(sig * 4.0f) * 0.3f;
+
+            out_left[n] = sig;
+            out_right[n] = sig;
+        }
 
-    float noise_modindex = get_lfnoise(0.1f);
-    float modIndex = ((noise_modindex + 1.0f) / 2.0f * 50.0f + 10.0f);
+        reverb.process(out_left, out_right, nframes);
 
-    float noise_cutoff = get_lfnoise(0.1f);
-    float cutoff = ((noise_cutoff + 1.0f) / 2.0f * 1000.0f + 200.0f);
-    float rq = 0.3f;
-    float Q = 1.0f / rq;
-    lpf.setFcQ(cutoff, Q);
+        noise_src = noise;
+        lpf = filt;
+        mod_phase = mod_ph;
+        carrier_phase = car_ph;
+        sub_phase = sub_ph;
+    }
 
-    float carrier_freq = 70.0f;
+private:
+    LFNoise own_noise;
+    LFNoise* shared_noise;
+    uint32_t mod_phase;
+    uint32_t carrier_phase;
+    uint32_t sub_phase;
+    BiquadLPF lpf;
+    FreeVerb<> reverb;
+};
 
-    float mod_incr = modFreq / SAMPLE_RATE;
-    float mod = sin_lut(mod_phase) * modIndex;
-    mod_phase = fmodf(mod_phase + mod_incr, 1.0f);
+// Third patch: simple fixed (no noise modulation, cutoff fixed at 800)
+class FmSynth3 {
+public:
+    FmSynth3() : mod_phase(0), carrier_phase(0), reverb_params_set(false) {}
+
+    // Samples between filter/reverb coefficient updates (1 = every sample)
+    void setControlRate(int samples) {
+        lpf.setControlRate(samples);
+        reverb.setControlRate(samples);
+    }
 
-    float cfreq = carrier_freq + mod;
-    float carrier_incr = cfreq / SAMPLE_RATE;
-    float tone = sin_lut(carrier_phase) * 0.2f;
-    carrier_phase = fmodf(carrier_phase + carrier_incr, 1.0f);
+    void process(float* out_left, float* out_right, int nframes) {
+        uint32_t mod_ph = mod_phase;
+        uint32_t car_ph = carrier_phase;
 
-    float sub_incr = 30.0f / SAMPLE_RATE;
-    float sub = sin_lut(sub_phase) * 0.1f;
-    sub_phase = fmodf(sub_phase + sub_incr, 1.0f);
+        const float modFreq = 40.0f;
+        const float modIndex = 50.0f;
+        const float carrier_freq = 100.0f;
+        const uint32_t mod_incr = phase_step(modFreq);
+        lpf.setFcQ(800.0f, 1.0f / 0.3f);  // rq=0.3
+        BiquadLPF filt = lpf;
 
-    float sig = tone + sub;
+        for (int n = 0; n < nframes; ++n) {
+            float mod = sine::Default::sin(mod_ph) * modIndex;
+            mod_ph += mod_incr;
 
-    sig = lpf.process(sig);
+            float cfreq = carrier_freq + mod;
+            float tone = sine::Default::sin(car_ph) * 0.2f;
+            car_ph += phase_step(cfreq);
 
-    sig = fast_tanh(sig * 4.0f) * 0.3f;
+            float sig = filt.process(tone);
 
-    float left = sig;
-    float right = sig;
-    reverb.setParams(0.3f, 0.6f, 0.3f);
-    reverb.process(left, right);
+            out_left[n] = sig;
+            out_right[n] = sig;
+        }
+
+        // The params are applied after the first frame's reverb, so the very
+        // first frame uses the FreeVerb defaults (matches the original order).
+        int head = (nframes > 0 && !reverb_params_set) ? 1 : 0;
+        reverb.process(out_left, out_right, head);
+        reverb.setParams(0.3f, 0.6f, 0.2f);
+        reverb_params_set = reverb_params_set || head;
+        reverb.process(out_left + head, out_right + head, nframes - head);
+
+        lpf = filt;
+        mod_phase = mod_ph;
+        carrier_phase = car_ph;
+    }
+
+private:
+    uint32_t mod_phase;
+    uint32_t carrier_phase;
+    BiquadLPF lpf;
+    FreeVerb<> reverb;
+    bool reverb_params_set;
+};
+
+#ifndef __SYNTHESIS__
+// Frames a host build of the top functions renders per synth.process() call
+#ifndef FM_TOP_BLOCK
+#define FM_TOP_BLOCK 64
+#endif
+
+// The top functions hand out one frame per call. On the host they render
+// FM_TOP_BLOCK frames at a time through the block path and return them in
+// order, which costs a frame what FmSynthN::process does instead of
+// FreeVerb's per-frame path. The synths take no input, so this adds no
+// latency; fm_synth1 and fm_synth2 do share shared_lfnoise(), so if both are
+// called in turn they now take its values a block at a time each.
+struct TopBuffer {
+    float left[FM_TOP_BLOCK], right[FM_TOP_BLOCK];
+    int pos = FM_TOP_BLOCK;
+
+    template <typename Synth>
+    void next(Synth& synth, float& l, float& r) {
+        if (pos == FM_TOP_BLOCK) {
+            synth.process(left, right, FM_TOP_BLOCK);
+            pos = 0;
+        }
+        l = left[pos];
+        r = right[pos];
+        pos++;
+    }
+};
+#endif
+
+// Top-level HLS function for first synth (processes one stereo sample per call)
+void fm_synth1(hls::stream<float>& out_left, hls::stream<float>& out_right) {
+#pragma HLS INTERFACE axis port=out_left
+#pragma HLS INTERFACE axis port=out_right
+#pragma HLS INTERFACE s_axilite port=return
+
+    static FmSynth1 synth(shared_lfnoise());
+
+    float left, right;
+#ifndef __SYNTHESIS__
+    static TopBuffer buffer;
+    buffer.next(synth, left, right);
+#else
+    synth.process(&left, &right, 1);
+#endif
 
     out_left << left;
     out_right << right;
 }
 
-// Third synth: simple fixed
-void fm_synth3(hls::stream<float>& out_left, hls::stream<float>& out_right) {
+// Second synth: single carrier
+void fm_synth2(hls::stream<float>& out_left, hls::stream<float>& out_right) {
 #pragma HLS INTERFACE axis port=out_left
 #pragma HLS INTERFACE axis port=out_right
 #pragma HLS INTERFACE s_axilite port=return
 
-    static float mod_phase = 0.0f;
-    static float carrier_phase = 0.0f;
-    static BiquadLPF lpf;  // Fixed cutoff 800
-    static SimpleFreeVerb reverb;
-
-    lpf.setFcQ(800.0f, 1.0f / 0.3f);  // rq=0.3
-
-    float modFreq = 40.0f;
-    float modIndex = 50.0f;
-    float carrier_freq = 100.0f;
+    static FmSynth2 synth(shared_lfnoise());
 
-    float mod_incr = modFreq / SAMPLE_RATE;
-    float mod = sin_lut(mod_phase) * modIndex;
-    mod_phase = fmodf(mod_phase + mod_incr, 1.0f);
+    float left, right;
+#ifndef __SYNTHESIS__
+    static TopBuffer buffer;
+    buffer.next(synth, left, right);
+#else
+    synth.process(&left, &right, 1);
+#endif
 
-    float cfreq = carrier_freq + mod;
-    float carrier_incr = cfreq / SAMPLE_RATE;
-    float tone = sin_lut(carrier_phase) * 0.2f;
-    carrier_phase = fmodf(carrier_phase + carrier_incr, 1.0f);
+    out_left << left;
+    out_right << right;
+}
 
-    float sig = lpf.process(tone);
+// Third synth: simple fixed
+void fm_synth3(hls::stream<float>& out_left, hls::stream<float>& out_right) {
+#pragma HLS INTERFACE axis port=out_left
+#pragma HLS INTERFACE axis port=out_right
+#pragma HLS INTERFACE s_axilite port=return
 
-    sig = reverb.process(sig, sig);  // Simplified, params fixed 0.3,0.6,0.2
+    static FmSynth3 synth;
 
-    reverb.setParams(0.3f, 0.6f, 0.2f);
+    float left, right;
+#ifndef __SYNTHESIS__
+    static TopBuffer buffer;
+    buffer.next(synth, left, right);
+#else
+    synth.process(&left, &right, 1);
+#endif
 
-    out_left << sig;
-    out_right << sig;
+    out_left << left;
+    out_right << right;
 }
@@ -2,61 +2,71 @@
 #include "hls_stream.h"
 #include "hls_math.h"
 
+#include "dsp/delay.h"
+#include "dsp/envelope.h"
+#include "dsp/fdn.h"
+#include "dsp/numeric.h"
+
 #define NUM_INST 16
 #define SR 44100
-#define REVERB_SIZE 22050  // Half second delay for reverb
+#define REVERB_RT60 2.0f  // Reverb decay to -60 dB, seconds
 
-void synth(hls::stream<ap_fixed<16,4>> &out_stream) {
-    #pragma HLS INTERFACE s_axilite port=return bundle=CTRL
-    #pragma HLS INTERFACE axis port=out_stream
+typedef ap_fixed<16,4> fixed_t;
+typedef ap_ufixed<16,0> phase_t;  // Phase in turns, wraps on overflow
+
+// Simple perc envelope: attack 0.01s, release 1s, linear segments
+constexpr env::Table perc_env = env::perc_table(0.01, 1.0, 0.0);
+constexpr uint32_t perc_env_inc = env::phase_inc((0.01 + 1.0) * SR);
+
+// One sample on any sample and phase types (dsp/numeric.h). Each
+// instantiation keeps its own voices and reverb.
+template <typename Sample, typename Phase>
+void synth_t(hls::stream<Sample> &out_stream) {
     #pragma HLS PIPELINE II=1
 
-    static ap_fixed<16,4> phase[NUM_INST] = {0};
+    static Phase phase[NUM_INST] = {0};
     #pragma HLS ARRAY_PARTITION variable=phase complete dim=1
 
-    static ap_fixed<16,4> env[NUM_INST] = {0};
-    #pragma HLS ARRAY_PARTITION variable=env complete dim=1
+    static uint32_t env_phase = 0;
 
-    static ap_fixed<16,4> reverb_buffer[REVERB_SIZE] = {0};
-    static int reverb_idx = 0;
+    // One reverb for all instruments, fed by their summed send
+    static fdn::Fdn<4, delay::Raw<Sample>> reverb(REVERB_RT60, SR);
 
     static int trigger_counter = 0;
     const int trigger_rate = SR / 10;  // Simplified trigger ~10 Hz instead of LFDNoise0
 
-    ap_fixed<16,4> sum = 0;
+    typename num::Traits<Sample>::accum_type send = 0;  // Wide enough for all 16 at full scale
+
+    // All instruments are triggered together, so one envelope serves all
+    if (trigger_counter == 0) {
+        env_phase = 0;  // Reset and trigger attack
+    }
+    Sample env = num::cast<Sample>(env::lookup(perc_env, env_phase));
+    env_phase = env::advance(env_phase, perc_env_inc);
 
     for (int i = 0; i < NUM_INST; i++) {
         #pragma HLS UNROLL
 
-        ap_fixed<16,4> freq = 32 + i;  // Fixed frequencies around 32-48 Hz
+        float freq = 32 + i;  // Fixed frequencies around 32-48 Hz
 
-        if (trigger_counter == 0) {
-            env[i] = 0;  // Reset and trigger attack
-        }
+        phase[i] += Phase(freq / SR);
+        num::wrap_turns(phase[i]);
 
-        phase[i] += 2 * M_PI * freq / SR;
-        if (phase[i] > 2 * M_PI) phase[i] -= 2 * M_PI;
+        Sample osc = num::sin_turns<Sample>(phase[i]);
 
-        ap_fixed<16,4> osc = hls::sinf(phase[i]);
-
-        // Simple perc envelope: attack 0.01s, release 1s
-        if (env[i] < 1.0) {
-            env[i] += 100.0 / SR;  // Attack rate
-        } else {
-            env[i] -= 1.0 / SR;  // Release rate
-            if (env[i] < 0) env[i] = 0;
-        }
-
-        ap_fixed<16,4> signal = osc * env[i];
-
-        // Simple reverb: single delay with feedback
-        ap_fixed<16,4> rev = reverb_buffer[reverb_idx];
-        reverb_buffer[reverb_idx] = signal + rev * 0.7;  // Feedback 0.7
-        sum += rev / NUM_INST;
+        Sample signal = osc * env;
+        send += signal;
     }
 
-    reverb_idx = (reverb_idx + 1) % REVERB_SIZE;
+    // The output is the reverb alone, as before
+    Sample sum = reverb.process(Sample(send / NUM_INST));
     trigger_counter = (trigger_counter + 1) % trigger_rate;
 
     out_stream.write(sum);
-}
\ No newline at end of file
+}
+
+void synth(hls::stream<fixed_t> &out_stream) {
+    #pragma HLS INTERFACE s_axilite port=return bundle=CTRL
+    #pragma HLS INTERFACE axis port=out_stream
+    synth_t<fixed_t, phase_t>(out_stream);
+}
@@ -2,6 +2,14 @@
 #include <hls_stream.h>
 #include <ap_fixed.h>
 
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "host/thread_pool.h"
+#endif
+
 // Use fixed-point for better FPGA performance
 typedef ap_fixed<16,8> float_t;
 
@@ -16,6 +24,7 @@ vec3 operator+(vec3 a, vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
 vec3 operator-(vec3 a, vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
 vec3 operator*(vec3 a, float_t b) { return {a.x * b, a.y * b, a.z * b}; }
 vec3 operator*(float_t a, vec3 b) { return b * a; }
+vec3 operator+(vec3 a, float_t b) { return {a.x + b, a.y + b, a.z + b}; }
 
 float_t length(vec2 v) { return hls::sqrt(v.x * v.x + v.y * v.y); }
 float_t length(vec3 v) { return hls::sqrt(v.x * v.x + v.y * v.y + v.z * v.z); }
@@ -94,6 +103,115 @@ vec3 bumpNormal(vec3 p, vec3 n, float_t bumpFactor, float_t iTime) {
     return normalize(n + grad * bumpFactor);
 }
 
+// Values that only depend on iTime and the frame size, computed once per
+// frame instead of once per pixel
+struct FrameUniforms {
+    float_t iTime;
+    int width, height;
+    vec3 ro, fwd, right, upv;
+    vec3 lightDir;
+};
+
+FrameUniforms frame_uniforms(float_t iTime, int width, int height) {
+    FrameUniforms f;
+    f.iTime = iTime;
+    f.width = width;
+    f.height = height;
+    float_t vel = iTime * 1.5f;
+    vec2 path_vel1 = path(vel - 1.0f);
+    f.ro = {path_vel1.x, path_vel1.y, vel - 1.0f};
+    vec2 path_vel = path(vel);
+    vec3 ta = {path_vel.x, path_vel.y, vel};
+    f.fwd = normalize(ta - f.ro);
+    vec3 upv = {0.0f, 1.0f, 0.0f};
+    f.right = cross(f.fwd, upv);
+    f.upv = cross(f.right, f.fwd);
+    f.lightDir = normalize(vec3{1.0f, 1.0f, 1.0f}); // Fixed light direction
+    return f;
+}
+
+// The part of the ray that only depends on the row: uv.y * upv
+vec3 row_uniforms(const FrameUniforms& f, int y) {
+    float_t fragCoord_y = float_t(y) + 0.5f;
+    float_t uv_y = (fragCoord_y * 2.0f - float_t(f.height)) / float_t(f.height);
+    return uv_y * f.upv;
+}
+
+// Camera ray through pixel x of the row
+vec3 pixel_ray(const FrameUniforms& f, const vec3& row, int x) {
+    #pragma HLS INLINE
+    float_t fragCoord_x = float_t(x) + 0.5f;
+    float_t uv_x = (fragCoord_x * 2.0f - float_t(f.width)) / float_t(f.height);
+    float_t fl = 1.2f;
+    return normalize(f.fwd + fl * (uv_x * f.right + row));
+}
+
+// Colour of pixel x of the row. Shared by the streaming HLS top function and
+// the host tile renderer; steps counts map() calls.
+vec3f shade_pixel(const FrameUniforms& f, const vec3& row, int x, int& steps) {
+    #pragma HLS INLINE
+    const float_t iTime = f.iTime;
+    const vec3 ro = f.ro;
+    const vec3 rd = pixel_ray(f, row, x);
+
+    float_t glow = 0.0f;
+    vec3 glowCol = {9.0f, 7.0f, 4.0f};
+    float_t t = 0.0f;
+    vec3 col = {0.0f, 0.0f, 0.0f};
+
+    loop_rm: for (int i = 0; i < 125; i++) {
+        #pragma HLS UNROLL factor=4
+        
+        vec3 p = ro + rd * t;
+        float_t d = map(p);
+        steps++;
+        glow += hls::exp(-d * 8.0f) * 0.005f;
+        
+        if (d < 0.01f) {
+            vec3 n = normal(p);
+            vec3 lightDir = f.lightDir;
+            n = bumpNormal(p, n, 0.02f, iTime);
+            
+            vec2 c = path(p.z);
+            float_t id_val = hls::floor(p.z * 4.0f - 0.25f);
+            float_t angle_val = hls::atan2(p.y - c.y, p.x - c.x);
+            
+            vec3 tileCol = {0.7f, 0.7f, 0.7f};
+            tileCol = tileCol + vec3{0.4f * hls::sin(id_val), 0.4f * hls::cos(id_val), 0.0f};
+            tileCol = tileCol + 0.3f * hls::sin(id_val * 0.5f + angle_val * 6.0f - iTime * 4.0f);
+            
+            vec3 tileGray = {0.5f, 0.5f, 0.5f};
+            float_t height_val = bumpFunction(p, iTime);
+            vec3 baseCol = mix(tileGray, tileCol, height_val);
+            
+            float_t diffuseL = hls::max(dot(n, lightDir), 0.0f);
+            col = baseCol * diffuseL;
+            
+            vec3 h = normalize(lightDir - rd);
+            float_t specL = hls::pow(hls::max(dot(n, h), 0.0f), 64.0f);
+            col = col + specL * 0.3f;
+            
+            vec3 r = reflect(rd, n);
+            vec3 reflCol = {0.5f, 0.5f, 0.5f};
+            col = mix(col, reflCol, 0.3f);
+            
+            break;
+        }
+        t += d;
+    }
+
+    col = col + glowCol * glow;
+    col = pow(col, vec3{2.2f, 2.2f, 2.2f});
+    
+    // Convert to float for output and clamp
+    vec3f output_col = {
+        hls::max(0.0f, hls::min(1.0f, float(col.x))),
+        hls::max(0.0f, hls::min(1.0f, float(col.y))),
+        hls::max(0.0f, hls::min(1.0f, float(col.z)))
+    };
+    return output_col;
+}
+
 void shader(
     hls::stream<vec3f>& output_stream,
     float_t iTime,
@@ -106,84 +224,65 @@ void shader(
     #pragma HLS INTERFACE s_axilite port=height
     #pragma HLS INTERFACE s_axilite port=return
     
+    const FrameUniforms f = frame_uniforms(iTime, width, height);
     loop_y: for (int y = 0; y < height; y++) {
+        const vec3 row = row_uniforms(f, y);
         loop_x: for (int x = 0; x < width; x++) {
             #pragma HLS PIPELINE II=1
-            
-            vec2 fragCoord = {float_t(x) + 0.5f, float_t(y) + 0.5f};
-            vec2 uv = {
-                (fragCoord.x * 2.0f - float_t(width)) / float_t(height),
-                (fragCoord.y * 2.0f - float_t(height)) / float_t(height)
-            };
-
-            float_t vel = iTime * 1.5f;
-            vec2 path_vel1 = path(vel - 1.0f);
-            vec3 ro = {path_vel1.x, path_vel1.y, vel - 1.0f};
-            vec2 path_vel = path(vel);
-            vec3 ta = {path_vel.x, path_vel.y, vel};
-            vec3 fwd = normalize(ta - ro);
-            vec3 upv = {0.0f, 1.0f, 0.0f};
-            vec3 right = cross(fwd, upv);
-            upv = cross(right, fwd);
-            float_t fl = 1.2f;
-            vec3 rd = normalize(fwd + fl * (uv.x * right + uv.y * upv));
-
-            float_t glow = 0.0f;
-            vec3 glowCol = {9.0f, 7.0f, 4.0f};
-            float_t t = 0.0f;
-            vec3 col = {0.0f, 0.0f, 0.0f};
-
-            loop_rm: for (int i = 0; i < 125; i++) {
-                #pragma HLS UNROLL factor=4
-                
-                vec3 p = ro + rd * t;
-                float_t d = map(p);
-                glow += hls::exp(-d * 8.0f) * 0.005f;
-                
-                if (d < 0.01f) {
-                    vec3 n = normal(p);
-                    vec3 lightDir = normalize(vec3(1.0f, 1.0f, 1.0f)); // Fixed light direction
-                    n = bumpNormal(p, n, 0.02f, iTime);
-                    
-                    vec2 c = path(p.z);
-                    float_t id_val = hls::floor(p.z * 4.0f - 0.25f);
-                    float_t angle_val = hls::atan2(p.y - c.y, p.x - c.x);
-                    
-                    vec3 tileCol = {0.7f, 0.7f, 0.7f};
-                    tileCol = tileCol + vec3{0.4f * hls::sin(id_val), 0.4f * hls::cos(id_val), 0.0f};
-                    tileCol = tileCol + 0.3f * hls::sin(id_val * 0.5f + angle_val * 6.0f - iTime * 4.0f);
-                    
-                    vec3 tileGray = {0.5f, 0.5f, 0.5f};
-                    float_t height_val = bumpFunction(p, iTime);
-                    vec3 baseCol = mix(tileGray, tileCol, height_val);
-                    
-                    float_t diffuseL = hls::max(dot(n, lightDir), 0.0f);
-                    col = baseCol * diffuseL;
-                    
-                    vec3 h = normalize(lightDir - rd);
-                    float_t specL = hls::pow(hls::max(dot(n, h), 0.0f), 64.0f);
-                    col = col + specL * 0.3f;
-                    
-                    vec3 r = reflect(rd, n);
-                    vec3 reflCol = {0.5f, 0.5f, 0.5f};
-                    col = mix(col, reflCol, 0.3f);
-                    
-                    break;
-                }
-                t += d;
-            }
-
-            col = col + glowCol * glow;
-            col = pow(col, vec3{2.2f, 2.2f, 2.2f});
-            
-            // Convert to float for output and clamp
-            vec3f output_col = {
-                hls::max(0.0f, hls::min(1.0f, float(col.x))),
-                hls::max(0.0f, hls::min(1.0f, float(col.y))),
-                hls::max(0.0f, hls::min(1.0f, float(col.z)))
-            };
-            
-            output_stream.write(output_col);
+            int steps = 0;
+            output_stream.write(shade_pixel(f, row, x, steps));
         }
     }
-}
\ No newline at end of file
+}
+
+#ifndef __SYNTHESIS__
+// Host tile renderer (not synthesized). The frame is cut into tile x tile
+// squares that run as tasks on a work-stealing pool, because the cost per
+// pixel varies a lot: rays that hit the wall early stop after a few steps,
+// rays that glow down the tunnel run all 125. Pixels go straight into a
+// shared row-major framebuffer (same order as the shader stream); tiles never
+// overlap, so no locking is needed.
+
+struct TileTiming {
+    int x0, y0, w, h;
+    int worker;       // Pool worker that rendered the tile
+    double seconds;
+    long long steps;  // map() calls
+};
+
+void shader_tiles(
+    vec3f* framebuffer,
+    float_t iTime,
+    int width,
+    int height,
+    int tile,
+    host::ThreadPool& pool,
+    std::vector<TileTiming>* timings  // Optional, one entry per tile in row-major tile order
+) {
+    const int tiles_x = (width + tile - 1) / tile;
+    const int tiles_y = (height + tile - 1) / tile;
+    if (timings) timings->assign(tiles_x * tiles_y, TileTiming());
+    const FrameUniforms f = frame_uniforms(iTime, width, height);
+
+    pool.run(tiles_x * tiles_y, [&](int index, int worker) {
+        auto t0 = std::chrono::steady_clock::now();
+        const int x0 = (index % tiles_x) * tile;
+        const int y0 = (index / tiles_x) * tile;
+        const int x1 = std::min(x0 + tile, width);
+        const int y1 = std::min(y0 + tile, height);
+        long long steps = 0;
+        for (int y = y0; y < y1; y++) {
+            const vec3 row = row_uniforms(f, y);
+            for (int x = x0; x < x1; x++) {
+                int n = 0;
+                framebuffer[y * width + x] = shade_pixel(f, row, x, n);
+                steps += n;
+            }
+        }
+        if (timings) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            (*timings)[index] = TileTiming{x0, y0, x1 - x0, y1 - y0, worker, seconds, steps};
+        }
+    });
+}
+#endif
@@ -2,11 +2,29 @@
 #include <hls_stream.h>
 #include <cmath>
 
+#include "dsp/blep.h"
+#include "dsp/delay.h"
+
+#ifndef __SYNTHESIS__
+#include "dsp/simd.h"
+#endif
+
 // Define constants
 #define NUM_OSC 6
 #define SAMPLE_RATE 44100.0f
 #define PI 3.14159265f
 
+// Storage codec of the reverb delay lines (dsp/delay.h). The default
+// delay::BF16 holds the six combs in 192 KB (16384 words each, rounded up
+// from 10000) where delay::F32 takes 384 KB, and runs 1.1-1.2x the integer-%
+// buffers it replaced; the output moves by 9.5e-4 of its peak
+// (bench/delay_bench.cpp, drone/vN/pow2_bf16). delay::Q2_13 is 30x closer
+// (2.7e-5) in the same space, but its int16 conversions make it no faster
+// than the % buffers (0.87-1.04x); delay::F32 is exact and 1.5x.
+#ifndef REVERB_STORE
+#define REVERB_STORE delay::BF16
+#endif
+
 // Simple PRNG for noise
 static unsigned int rand_state = 123456789;
 
@@ -42,7 +60,8 @@ public:
     }
 };
 
-// Saw oscillator
+// Saw oscillator, band-limited by PolyBLEP (dsp/blep.h) so the 30-2000 Hz
+// sweep does not alias at 1x rate
 class Saw {
 public:
     float phase;
@@ -51,33 +70,27 @@ public:
     Saw(float initial_freq = 440.0f) : phase(0.0f), freq(initial_freq) {}
 
     float process() {
-        float out = phase * 2.0f - 1.0f;
-        phase += freq / SAMPLE_RATE;
-        if (phase > 1.0f) phase -= 1.0f;
+        const float dt = freq / SAMPLE_RATE;
+        float out = blep::saw(phase, dt);
+        phase += dt;
+        if (phase >= 1.0f) phase -= 1.0f;
         return out;
     }
 };
 
-// Simple reverb approximation
-template<int BUFFER_SIZE>
+// Simple reverb approximation: a feedback comb BUFFER_SIZE samples long
+template<int BUFFER_SIZE, typename Store = REVERB_STORE>
 class SimpleReverb {
 public:
-    float buffer[BUFFER_SIZE];
-    int idx;
+    delay::FixedDelay<BUFFER_SIZE, Store> line;
     float damp;
     float room;
 
-    SimpleReverb(float d = 0.6f, float r = 0.5f) : idx(0), damp(d), room(r) {
-        for (int i = 0; i < BUFFER_SIZE; i++) {
-#pragma HLS UNROLL
-            buffer[i] = 0.0f;
-        }
-    }
+    SimpleReverb(float d = 0.6f, float r = 0.5f) : damp(d), room(r) {}
 
     float process(float in) {
-        float out = buffer[idx];
-        buffer[idx] = in + out * room;
-        idx = (idx + 1) % BUFFER_SIZE;
+        float out = line.read(BUFFER_SIZE);
+        line.write(in + out * room);
         return out * (1.0f - damp) + in * 0.8f;
     }
 };
@@ -123,4 +136,73 @@ void ambient_drone(hls::stream<float> &outL, hls::stream<float> &outR, int num_s
         outL.write(sound);
         outR.write(sound);
     }
-}
\ No newline at end of file
+}
+
+#ifndef __SYNTHESIS__
+// Host-side bank of N PolyBLEP saws stepped together, simd::kWidth saws per
+// vector, for the detuned NUM_OSC stack. Phases advance exactly as in N Saw
+// instances; the output matches them to ~1e-6 (the residual multiplies by
+// 1 / dt instead of dividing).
+template <int N>
+class SawBank {
+public:
+    static const int kVecs = (N + simd::kWidth - 1) / simd::kWidth;
+    static const int kLanes = kVecs * simd::kWidth;
+
+    alignas(64) float phase[kLanes] = {};
+
+    // One sample of every saw at freq[0..N) Hz into out[0..N)
+    void process(const float* freq, float* out) {
+        alignas(64) float f[kLanes];
+        alignas(64) float o[kLanes];
+        load_freq(freq, f);
+        for (int v = 0; v < kVecs; v++) {
+            const simd::vfloat dt = simd::load(f + v * simd::kWidth) / simd::set1(SAMPLE_RATE);
+            simd::vfloat ph = simd::load(phase + v * simd::kWidth);
+            simd::store(o + v * simd::kWidth, step(ph, dt, simd::set1(1.0f) / dt));
+            simd::store(phase + v * simd::kWidth, ph);
+        }
+        for (int i = 0; i < N; i++) out[i] = o[i];
+    }
+
+    // n samples at freq[0..N) Hz held for the block (control rate), into
+    // out[s * N + i]
+    void render(const float* freq, float* out, int n) {
+        alignas(64) float f[kLanes];
+        alignas(64) float o[kLanes];
+        load_freq(freq, f);
+        simd::vfloat ph[kVecs], dt[kVecs], inv_dt[kVecs];
+        for (int v = 0; v < kVecs; v++) {
+            ph[v] = simd::load(phase + v * simd::kWidth);
+            dt[v] = simd::load(f + v * simd::kWidth) / simd::set1(SAMPLE_RATE);
+            inv_dt[v] = simd::set1(1.0f) / dt[v];
+        }
+        for (int s = 0; s < n; s++) {
+            for (int v = 0; v < kVecs; v++) simd::store(o + v * simd::kWidth, step(ph[v], dt[v], inv_dt[v]));
+            for (int i = 0; i < N; i++) out[s * N + i] = o[i];
+        }
+        for (int v = 0; v < kVecs; v++) simd::store(phase + v * simd::kWidth, ph[v]);
+    }
+
+private:
+    // freq[0..N) into f, with 1 Hz in the padding lanes: any nonzero rate
+    // keeps their 1 / dt finite, where 0 Hz turned them into inf and NaN
+    static void load_freq(const float* freq, float* f) {
+        for (int i = 0; i < kLanes; i++) f[i] = i < N ? freq[i] : 1.0f;
+    }
+
+    // blep::saw with both residual branches computed and selected per lane;
+    // advances ph
+    static simd::vfloat step(simd::vfloat& ph, simd::vfloat dt, simd::vfloat inv_dt) {
+        const simd::vfloat one = simd::set1(1.0f);
+        const simd::vfloat x0 = ph * inv_dt - one;
+        const simd::vfloat x1 = (ph - one) * inv_dt + one;
+        const simd::vfloat residual = simd::select(ph < dt, simd::zero() - x0 * x0,
+                                                   simd::select(ph > one - dt, x1 * x1, simd::zero()));
+        const simd::vfloat out = simd::set1(2.0f) * ph - one - residual;
+        ph = ph + dt;
+        ph = simd::select(ph >= one, ph - one, ph);
+        return out;
+    }
+};
+#endif
@@ -33,6 +33,10 @@ vec3_t fract(vec3_t v) {
             v.z - hls::floor(v.z)};
 }
 
+vec3_t operator-(vec3_t v, fixed_t s) {
+    return {v.x - s, v.y - s, v.z - s};
+}
+
 vec3_t abs(vec3_t v) {
     return {hls::abs(v.x), hls::abs(v.y), hls::abs(v.z)};
 }
@@ -45,6 +49,60 @@ fixed_t length(vec3_t v) {
     return hls::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
 }
 
+// Values that only depend on iTime and the frame size, computed once per
+// frame instead of once per pixel
+struct frame_uniforms_t {
+    fixed_t iResolution_x, iResolution_y;
+    fixed_t time;
+    fixed_t zoom;
+    fixed_t rayOrigin_z;
+    fixed_t z[5];              // Depth of each grid layer
+    fixed32_t time3, time4;    // Node phase offsets
+    vec2_t beamDir[3];
+    fixed32_t beamShift;       // sin(time * 2)
+    fixed32_t glowGain;        // 0.5 + 0.5 * sin(time * 10)
+};
+
+// Values that only depend on the row
+struct row_uniforms_t {
+    fixed_t uv_y;
+    fixed32_t beamRow[3];      // uv.y * beamDir.y + beamShift
+};
+
+frame_uniforms_t frame_uniforms(fixed_t iTime, int width, int height) {
+    frame_uniforms_t f;
+    f.iResolution_x = fixed_t(width);
+    f.iResolution_y = fixed_t(height);
+    f.time = iTime;
+    f.zoom = fixed_t(1.0) + hls::sin(f.time * fixed_t(0.5)) * fixed_t(0.2);
+    f.rayOrigin_z = -f.time * fixed_t(0.5);
+    for (int i = 0; i < 5; i++) {
+        #pragma HLS UNROLL
+        f.z[i] = hls::fmod(f.rayOrigin_z + fixed_t(i) * fixed_t(0.3), fixed_t(1.0));
+    }
+    f.time3 = f.time * fixed_t(3.0);
+    f.time4 = f.time * fixed_t(4.0);
+    for (int j = 0; j < 3; j++) {
+        #pragma HLS UNROLL
+        fixed_t beamTime = f.time * (fixed_t(1.0) + fixed_t(j) * fixed_t(0.2));
+        f.beamDir[j] = {hls::cos(beamTime), hls::sin(beamTime)};
+    }
+    f.beamShift = hls::sin(f.time * fixed_t(2.0));
+    f.glowGain = fixed_t(0.5) + fixed_t(0.5) * hls::sin(f.time * fixed_t(10.0));
+    return f;
+}
+
+row_uniforms_t row_uniforms(const frame_uniforms_t& f, int y) {
+    row_uniforms_t r;
+    r.uv_y = fixed_t(y) / f.iResolution_y;
+    r.uv_y -= fixed_t(0.5);
+    for (int j = 0; j < 3; j++) {
+        #pragma HLS UNROLL
+        r.beamRow[j] = r.uv_y * f.beamDir[j].y + f.beamShift;
+    }
+    return r;
+}
+
 // Main hyperspatial construct function
 void hyperspatial_construct(
     hls::stream<ap_axiu<24,1,1,1>> &src_axi,
@@ -60,30 +118,28 @@ void hyperspatial_construct(
     #pragma HLS INTERFACE s_axilite port=height bundle=CTRL
     #pragma HLS INTERFACE s_axilite port=return bundle=CTRL
 
-    fixed_t iResolution_x = fixed_t(width);
-    fixed_t iResolution_y = fixed_t(height);
+    const frame_uniforms_t f = frame_uniforms(iTime, width, height);
+    fixed_t iResolution_x = f.iResolution_x;
+    fixed_t iResolution_y = f.iResolution_y;
     
     ap_axiu<24,1,1,1> pixel;
     
     for (int y = 0; y < height; y++) {
+        const row_uniforms_t row = row_uniforms(f, y);
         for (int x = 0; x < width; x++) {
             #pragma HLS PIPELINE II=1
             #pragma HLS LOOP_FLATTEN off
             
             src_axi.read(pixel);
             
-            vec2_t fragCoord = {fixed_t(x), fixed_t(y)};
-            vec2_t uv = {fragCoord.x / iResolution_x, fragCoord.y / iResolution_y};
+            vec2_t uv = {fixed_t(x) / iResolution_x, row.uv_y};
             uv.x -= fixed_t(0.5);
-            uv.y -= fixed_t(0.5);
             uv.x *= iResolution_x / iResolution_y;
             
-            fixed_t time = iTime;
-            
             // Create perspective effect
-            fixed_t zoom = fixed_t(1.0) + hls::sin(time * fixed_t(0.5)) * fixed_t(0.2);
+            fixed_t zoom = f.zoom;
             vec3_t rayDir = normalize({uv.x, uv.y, fixed_t(1.5)});
-            vec3_t rayOrigin = {fixed_t(0.0), fixed_t(0.0), -time * fixed_t(0.5)};
+            vec3_t rayOrigin = {fixed_t(0.0), fixed_t(0.0), f.rayOrigin_z};
             
             vec3_t col = {fixed_t(0.0), fixed_t(0.0), fixed_t(0.0)};
             
@@ -92,8 +148,7 @@ void hyperspatial_construct(
                 #pragma HLS UNROLL factor=2
                 #pragma HLS PIPELINE II=1
                 
-                fixed_t iter = fixed_t(i);
-                fixed_t z = hls::fmod(rayOrigin.z + iter * fixed_t(0.3), fixed_t(1.0));
+                fixed_t z = f.z[i];
                 vec3_t p = {rayOrigin.x + rayDir.x * z,
                            rayOrigin.y + rayDir.y * z,
                            rayOrigin.z + rayDir.z * z};
@@ -104,7 +159,7 @@ void hyperspatial_construct(
                                        p.z * fixed_t(20.0) * zoom}) - fixed_t(0.5));
                 
                 // Grid lines with perspective
-                fixed_t gridLines = smoothstep(fixed_t(0.08), fixed_t(0.06), length({grid.x, grid.y}));
+                fixed_t gridLines = smoothstep(fixed_t(0.08), fixed_t(0.06), length(vec2_t{grid.x, grid.y}));
                 gridLines *= smoothstep(fixed_t(0.1), fixed_t(0.0), grid.z);
                 
                 vec3_t gridColor = {fixed_t(0.3), fixed_t(0.6), fixed_t(1.0)};
@@ -120,11 +175,11 @@ void hyperspatial_construct(
                 fixed_t node = hls::sin(nodePos.x * fixed_t(1.2) + 
                                       nodePos.y * fixed_t(1.8) + 
                                       nodePos.z * fixed_t(2.1) + 
-                                      time * fixed_t(3.0));
+                                      f.time3);
                 node = fixed_t(0.5) + fixed_t(0.5) * node;
                 
                 fixed_t nodeSize = fixed_t(0.1) + 
-                                 fixed_t(0.05) * hls::sin(time * fixed_t(4.0) + 
+                                 fixed_t(0.05) * hls::sin(f.time4 + 
                                                          (nodePos.x * fixed_t(1.0) + 
                                                           nodePos.y * fixed_t(2.0) + 
                                                           nodePos.z * fixed_t(3.0)));
@@ -148,10 +203,7 @@ void hyperspatial_construct(
             fixed_t beam = fixed_t(0.0);
             for (int j = 0; j < 3; j++) {
                 #pragma HLS UNROLL
-                fixed_t j_iter = fixed_t(j);
-                fixed_t beamTime = time * (fixed_t(1.0) + j_iter * fixed_t(0.2));
-                vec2_t beamDir = {hls::cos(beamTime), hls::sin(beamTime)};
-                fixed_t p_val = uv.x * beamDir.x + uv.y * beamDir.y + hls::sin(time * fixed_t(2.0));
+                fixed_t p_val = uv.x * f.beamDir[j].x + row.beamRow[j];
                 beam += smoothstep(fixed_t(0.3), fixed_t(0.0), hls::abs(p_val)) * (fixed_t(1.0) - hls::abs(p_val));
             }
             
@@ -161,9 +213,9 @@ void hyperspatial_construct(
             col.z += beam * beamColor.z;
             
             // Apply glow and final effects
-            vec3_t glow = {col.x * (fixed_t(0.5) + fixed_t(0.5) * hls::sin(time * fixed_t(10.0))),
-                          col.y * (fixed_t(0.5) + fixed_t(0.5) * hls::sin(time * fixed_t(10.0))),
-                          col.z * (fixed_t(0.5) + fixed_t(0.5) * hls::sin(time * fixed_t(10.0)))};
+            vec3_t glow = {col.x * f.glowGain,
+                          col.y * f.glowGain,
+                          col.z * f.glowGain};
             
             col.x = hls::pow(col.x, fixed_t(1.2));
             col.y = hls::pow(col.y, fixed_t(1.2));
@@ -1,24 +1,222 @@
+#define __CL_ENABLE_EXCEPTIONS  // cl::Error is caught below
 #include <CL/cl.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <random>
 #include <fstream>
 #include <cmath>
+#include <filesystem>
+#include <functional>
+#include <thread>
 
-// Sine table size and precompute
-const int SINE_TABLE_SIZE = 1024;
-std::vector<float> sine_table(SINE_TABLE_SIZE);
-void init_sine_table() {
-    for (int i = 0; i < SINE_TABLE_SIZE; ++i) {
-        sine_table[i] = std::sin(2.0f * M_PI * i / SINE_TABLE_SIZE);
+#include "dsp/sine.h"
+
+// Sine table of the device kernels: the first 1024 points of the compile-time
+// table of sine::Lut<10> (dsp/sine.h). The kernels index it with the top 10
+// bits of their 32-bit phases, without interpolation.
+typedef sine::Lut<10> SineTable;
+const int SINE_TABLE_SIZE = SineTable::kSize;
+std::vector<float> sine_table(SineTable::table.v, SineTable::table.v + SINE_TABLE_SIZE);
+
+// Samples rendered per block (per oscillator)
+const int DEFAULT_BLOCK_SAMPLES = 65536;
+
+// Samples per work-item in the data-parallel path
+const int FM_BLOCK_SAMPLES = 64;
+
+// Buffer sets in flight: block n computes while n - 1 is read back and the
+// host converts and writes n - 2
+const int PIPELINE_SETS = 3;
+
+// 16-bit stereo WAV written as it is rendered. The header goes out with
+// placeholder sizes and is patched by close(), so only the current block is
+// ever held in memory.
+class WavWriter {
+public:
+    bool open(const char* path) {
+        file_.open(path, std::ios::binary);
+        if (!file_) return false;
+        const char* header = "RIFF----WAVEfmt \x10\x00\x00\x00\x01\x00\x02\x00\x44\xAC\x00\x00\x10\xB1\x02\x00\x04\x00\x10\x00data----";
+        file_.write(header, 44);
+        data_size_ = 0;
+        return bool(file_);
+    }
+
+    // Appends interleaved stereo frames; false once the 4 GiB RIFF limit
+    // (~6.7 h at 44.1 kHz) would be exceeded or the write fails
+    bool append(const int16_t* frames, size_t num_frames) {
+        const uint64_t bytes = num_frames * 2 * sizeof(int16_t);
+        if (data_size_ + bytes > 0xFFFFFFFFull - 36) return false;
+        file_.write(reinterpret_cast<const char*>(frames), bytes);
+        data_size_ += bytes;
+        return bool(file_);
+    }
+
+    bool close() {
+        const uint32_t file_size = static_cast<uint32_t>(36 + data_size_);
+        const uint32_t data_size = static_cast<uint32_t>(data_size_);
+        file_.seekp(4);
+        file_.write(reinterpret_cast<const char*>(&file_size), 4);
+        file_.seekp(40);
+        file_.write(reinterpret_cast<const char*>(&data_size), 4);
+        file_.close();
+        return !file_.fail();
+    }
+
+    uint64_t bytes_written() const { return data_size_ + 44; }
+
+private:
+    std::ofstream file_;
+    uint64_t data_size_ = 0;
+};
+
+// Built program binaries, cached on disk so later runs skip the compile.
+// An entry is keyed by a hash of everything that can change the binary:
+// the kernel source, the build options, and the platform, device and
+// driver names and versions. It is loaded through CL_PROGRAM_BINARIES and
+// still goes through program.build (cheap for a binary). Anything that
+// fails to load or build (missing, stale or corrupt entry) falls back to a
+// source build, which then replaces the entry.
+class ProgramCache {
+public:
+    explicit ProgramCache(std::string dir) : dir_(std::move(dir)) {}
+
+    // Source or cached build of source for device; from_cache says which
+    cl::Program build(const cl::Context& context, const cl::Device& device, const std::string& source,
+                      const std::string& options, bool* from_cache) {
+        const std::string path = entry_path(device, source, options);
+        *from_cache = false;
+        if (!dir_.empty()) {
+            std::vector<unsigned char> binary;
+            if (read_file(path, binary)) {
+                try {
+                    cl::Program::Binaries binaries(1, std::make_pair(binary.data(), binary.size()));
+                    cl::Program program(context, {device}, binaries);
+                    program.build({device}, options.c_str());
+                    *from_cache = true;
+                    return program;
+                } catch (cl::Error&) {
+                    // Stale or corrupt entry: rebuild from source below
+                }
+            }
+        }
+
+        cl::Program program(context, source);
+        program.build({device}, options.c_str());  // Throws cl::Error with the log on the device
+        if (!dir_.empty()) store(program, path);
+        return program;
+    }
+
+private:
+    // 64-bit FNV-1a
+    static uint64_t hash(const std::string& s, uint64_t h = 1469598103934665603ull) {
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::string entry_path(const cl::Device& device, const std::string& source, const std::string& options) const {
+        const cl::Platform platform(device.getInfo<CL_DEVICE_PLATFORM>());
+        std::string key = source;
+        for (const std::string& part : {options, platform.getInfo<CL_PLATFORM_NAME>(), platform.getInfo<CL_PLATFORM_VERSION>(),
+                                        device.getInfo<CL_DEVICE_NAME>(), device.getInfo<CL_DEVICE_VERSION>(),
+                                        device.getInfo<CL_DRIVER_VERSION>()}) {
+            key += '\0';
+            key += part;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash(key));
+        return dir_ + "/" + name;
+    }
+
+    static bool read_file(const std::string& path, std::vector<unsigned char>& data) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        return !data.empty();
     }
+
+    // Written to a temporary name and renamed, so a concurrent run never
+    // reads a partial entry
+    void store(const cl::Program& program, const std::string& path) const {
+        size_t size = 0;
+        if (clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, nullptr) != CL_SUCCESS || size == 0) return;
+        std::vector<unsigned char> binary(size);
+        unsigned char* ptr = binary.data();
+        if (clGetProgramInfo(program(), CL_PROGRAM_BINARIES, sizeof(ptr), &ptr, nullptr) != CL_SUCCESS) return;
+
+        std::filesystem::create_directories(dir_);
+        std::ostringstream tmp;
+        tmp << path << ".tmp" << std::hex << std::hash<std::thread::id>()(std::this_thread::get_id()) << std::chrono::steady_clock::now().time_since_epoch().count();
+        {
+            std::ofstream f(tmp.str(), std::ios::binary);
+            if (!f.write(reinterpret_cast<const char*>(binary.data()), binary.size())) return;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp.str(), path, ec);
+        if (ec) std::filesystem::remove(tmp.str(), ec);
+    }
+
+    std::string dir_;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 }
 
-int main() {
+// Usage: 9 [--duration SECONDS] [--block SAMPLES] [--fixed-gain] [--serial] [--verify]
+//          [--cache-dir DIR] [--no-cache]
+// The render is streamed in blocks: peak memory is O(block), not O(duration).
+// Peak normalization needs the whole signal, so by default the blocks are
+// rendered twice (a peak pass that keeps only max |x|, then the write pass);
+// --fixed-gain skips the first pass and scales by the mix's bound of 1.
+// Blocks are rendered data-parallel unless --serial picks the one work-item
+// per oscillator kernel; --verify renders every block both ways and counts
+// the samples whose bits differ. Built kernels are cached in --cache-dir
+// (default .clcache, or $FM_CL_CACHE_DIR); --no-cache always compiles.
+int main(int argc, char** argv) {
     // Parameters
     const int sample_rate = 44100;
-    const float duration = 5.0f;
-    const int num_samples = static_cast<int>(sample_rate * duration);
+    float duration = 5.0f;
+    int block_samples = DEFAULT_BLOCK_SAMPLES;
+    bool fixed_gain = false;
+    bool serial = false;
+    bool verify = false;
+    const char* cache_env = std::getenv("FM_CL_CACHE_DIR");
+    std::string cache_dir = cache_env ? cache_env : ".clcache";
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--duration") && i + 1 < argc) {
+            duration = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--block") && i + 1 < argc) {
+            block_samples = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--fixed-gain")) {
+            fixed_gain = true;
+        } else if (!std::strcmp(argv[i], "--serial")) {
+            serial = true;
+        } else if (!std::strcmp(argv[i], "--verify")) {
+            verify = true;
+        } else if (!std::strcmp(argv[i], "--cache-dir") && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--no-cache")) {
+            cache_dir.clear();
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--duration SECONDS] [--block SAMPLES] [--fixed-gain] [--serial] [--verify]"
+                      << " [--cache-dir DIR] [--no-cache]" << std::endl;
+            return 1;
+        }
+    }
+    const long long num_samples = static_cast<long long>(sample_rate * (double)duration);
+    block_samples = static_cast<int>(std::min<long long>(block_samples, std::max(1LL, num_samples)));
     const int num_oscillators = 8;
     const std::vector<float> freq_choices = {3.14f * 0.5f, 3.14f * 1.0f, 3.14f * 2.0f};
     std::random_device rd;
@@ -34,7 +232,7 @@ int main() {
         lfo_freqs[i] = freq_choices[choice_dist(gen)];
     }
 
-    init_sine_table();
+    const auto t_launch = std::chrono::steady_clock::now();
 
     // Get platform and device
     std::vector<cl::Platform> platforms;
@@ -43,9 +241,22 @@ int main() {
         std::cerr << "No OpenCL platforms found." << std::endl;
         return 1;
     }
-    cl::Platform platform = platforms[0];
+    // A GPU or DSP if any platform has one, then a CPU device (PoCL), then
+    // whatever there is. With exceptions on, getDevices throws
+    // CL_DEVICE_NOT_FOUND instead of returning an empty list.
     std::vector<cl::Device> devices;
-    platform.getDevices(CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_ACCELERATOR, &devices);  // Prefer GPU or DSP
+    for (cl_device_type type : {(cl_device_type)(CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_ACCELERATOR),
+                                (cl_device_type)CL_DEVICE_TYPE_CPU, (cl_device_type)CL_DEVICE_TYPE_ALL}) {
+        for (cl::Platform& p : platforms) {
+            try {
+                p.getDevices(type, &devices);
+            } catch (const cl::Error&) {
+                devices.clear();
+            }
+            if (!devices.empty()) break;
+        }
+        if (!devices.empty()) break;
+    }
     if (devices.empty()) {
         std::cerr << "No OpenCL devices found." << std::endl;
         return 1;
@@ -53,10 +264,48 @@ int main() {
     cl::Device device = devices[0];
 
     cl::Context context(device);
-    cl::CommandQueue queue(context, device);
+    // Kernels and transfers go to separate in-order queues so a readback can
+    // run while the next block computes; profiling feeds the stage timings
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+    cl::CommandQueue io_queue(context, device, CL_QUEUE_PROFILING_ENABLE);
 
-    // Kernel source
+    // Kernel source. Two ways to render: fm_oscillator is the original
+    // serial accumulator, one work-item per oscillator looping over the whole
+    // block. The other kernels split the block into FM_BLOCK_SAMPLES-sample
+    // pieces, one work-item each:
+    //   fm_inc_table   the phase increment depends only on the LFO table
+    //                  index, so it is tabulated once (table_size entries)
+    //   fm_block_sums  per piece and oscillator, the wrapping uint sum of the
+    //                  piece's increments (the LFO phase is closed-form:
+    //                  sample * lfo_step)
+    //   fm_block_scan  per oscillator, an exclusive prefix sum of those sums
+    //                  from the carried phase gives each piece its start phase
+    //   fm_render_mix  per piece, every oscillator from its start phase,
+    //                  mixed on the device
+    // Integer addition is associative, so every phase, and the output, is
+    // bit-identical to the serial loop. FP_CONTRACT is off so that both paths
+    // round the increment expression the same way.
     std::string kernel_source = R"(
+        #pragma OPENCL FP_CONTRACT OFF
+
+        // Fixed-point phase: 2^32 per table cycle. (1U << 32 is undefined in
+        // OpenCL C, so the scale is computed in 64 bits.)
+        #define PHASE_SCALE(table_size) ((uint)((1UL << 32) / (table_size)))
+
+        uint fm_phase_inc(float lfo, float base_freq, float mod_depth, int sample_rate, int table_size) {
+            // Modulated frequency
+            float mod_freq = base_freq + mod_depth * lfo;
+            return (uint)(mod_freq / sample_rate * table_size * PHASE_SCALE(table_size));
+        }
+
+        uint fm_lfo_step(float lfo_freq, int sample_rate, int table_size) {
+            const float lfo_phase_inc = lfo_freq / sample_rate * table_size;
+            return (uint)(lfo_phase_inc * PHASE_SCALE(table_size));
+        }
+
+        // Renders num_samples samples of one oscillator into its row of output
+        // and carries both phase accumulators across calls in state, so
+        // consecutive blocks continue one unbroken signal.
         __kernel void fm_oscillator(
             __global float* output,
             __global const float* lfo_freqs,
@@ -66,105 +315,377 @@ int main() {
             const int sample_rate,
             const int num_samples,
             const int table_size,
-            const int oscillator_id) {
-            const float lfo_phase_inc = lfo_freqs[oscillator_id] / sample_rate * table_size;
-            const uint phase_scale = (1U << 32) / table_size;  // For fixed-point phase
-            uint phase_acc = 0;
-            uint lfo_phase_acc = 0;
+            const int oscillator_id,
+            __global uint* state) {
+            const uint lfo_step = fm_lfo_step(lfo_freqs[oscillator_id], sample_rate, table_size);
+            uint phase_acc = state[2 * oscillator_id];
+            uint lfo_phase_acc = state[2 * oscillator_id + 1];
             for (int sample = 0; sample < num_samples; ++sample) {
                 // LFO value
                 int lfo_idx = (lfo_phase_acc >> (32 - 10)) % table_size;  // Assuming 10-bit for 1024
                 float lfo = sine_table[lfo_idx];
-                // Modulated frequency
-                float mod_freq = base_freq + mod_depth * lfo;
-                // Phase increment
-                uint phase_inc = (uint)(mod_freq / sample_rate * table_size * phase_scale);
                 // Accumulate phase and get sine
-                phase_acc += phase_inc;
+                phase_acc += fm_phase_inc(lfo, base_freq, mod_depth, sample_rate, table_size);
                 int idx = (phase_acc >> (32 - 10)) % table_size;
                 output[oscillator_id * num_samples + sample] = sine_table[idx];
                 // Update LFO phase
-                lfo_phase_acc += (uint)(lfo_phase_inc * phase_scale);
+                lfo_phase_acc += lfo_step;
+            }
+            state[2 * oscillator_id] = phase_acc;
+            state[2 * oscillator_id + 1] = lfo_phase_acc;
+        }
+
+        __kernel void fm_inc_table(
+            __global uint* inc_table,
+            __global const float* sine_table,
+            const float base_freq,
+            const float mod_depth,
+            const int sample_rate,
+            const int table_size) {
+            const int i = get_global_id(0);
+            inc_table[i] = fm_phase_inc(sine_table[i], base_freq, mod_depth, sample_rate, table_size);
+        }
+
+        // block_phase[osc * num_pieces + piece] = sum of the piece's increments
+        __kernel void fm_block_sums(
+            __global uint* block_phase,
+            __global const uint* inc_table,
+            __global const float* lfo_freqs,
+            const int sample_rate,
+            const int num_samples,
+            const int table_size,
+            const int num_oscillators,
+            const uint first_sample,
+            const int piece_samples) {
+            const int piece = get_global_id(0);
+            const int num_pieces = get_global_size(0);
+            const int begin = piece * piece_samples;
+            const int end = min(begin + piece_samples, num_samples);
+            for (int osc = 0; osc < num_oscillators; ++osc) {
+                const uint lfo_step = fm_lfo_step(lfo_freqs[osc], sample_rate, table_size);
+                uint lfo_phase_acc = (first_sample + begin) * lfo_step;
+                uint sum = 0;
+                for (int sample = begin; sample < end; ++sample) {
+                    sum += inc_table[(lfo_phase_acc >> (32 - 10)) % table_size];
+                    lfo_phase_acc += lfo_step;
+                }
+                block_phase[osc * num_pieces + piece] = sum;
+            }
+        }
+
+        // Turns the sums into start phases in place; phase[osc] carries the
+        // phase from block to block
+        __kernel void fm_block_scan(
+            __global uint* block_phase,
+            __global uint* phase,
+            const int num_pieces) {
+            const int osc = get_global_id(0);
+            uint acc = phase[osc];
+            for (int piece = 0; piece < num_pieces; ++piece) {
+                const uint sum = block_phase[osc * num_pieces + piece];
+                block_phase[osc * num_pieces + piece] = acc;
+                acc += sum;
+            }
+            phase[osc] = acc;
+        }
+
+        // Same mix as the host loop: 0 + osc 0 + osc 1 + ..., then / count
+        __kernel void fm_render_mix(
+            __global float* mixed,
+            __global const uint* block_phase,
+            __global const uint* inc_table,
+            __global const float* sine_table,
+            __global const float* lfo_freqs,
+            const int sample_rate,
+            const int num_samples,
+            const int table_size,
+            const int num_oscillators,
+            const uint first_sample,
+            const int piece_samples) {
+            const int piece = get_global_id(0);
+            const int num_pieces = get_global_size(0);
+            const int begin = piece * piece_samples;
+            const int end = min(begin + piece_samples, num_samples);
+            for (int osc = 0; osc < num_oscillators; ++osc) {
+                const uint lfo_step = fm_lfo_step(lfo_freqs[osc], sample_rate, table_size);
+                uint lfo_phase_acc = (first_sample + begin) * lfo_step;
+                uint phase_acc = block_phase[osc * num_pieces + piece];
+                for (int sample = begin; sample < end; ++sample) {
+                    phase_acc += inc_table[(lfo_phase_acc >> (32 - 10)) % table_size];
+                    const float value = sine_table[(phase_acc >> (32 - 10)) % table_size];
+                    mixed[sample] = (osc == 0 ? 0.0f : mixed[sample]) + value;
+                    lfo_phase_acc += lfo_step;
+                }
+            }
+            for (int sample = begin; sample < end; ++sample) {
+                mixed[sample] /= num_oscillators;
             }
         }
     )";
 
-    // Build program
-    cl::Program program(context, kernel_source);
+    // Build program (or load it from the binary cache)
+    const std::string build_options = "";
+    const auto t_build = std::chrono::steady_clock::now();
+    cl::Program program;
+    bool from_cache = false;
     try {
-        program.build({device});
+        program = ProgramCache(cache_dir).build(context, device, kernel_source, build_options, &from_cache);
     } catch (cl::Error& e) {
-        std::cerr << "Build error: " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << std::endl;
+        cl::Program failed(context, kernel_source);
+        try {
+            failed.build({device}, build_options.c_str());
+        } catch (cl::Error&) {
+        }
+        std::cerr << "Build error: " << failed.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << std::endl;
         return 1;
     }
+    const double build_seconds = seconds_since(t_build);
 
     cl::Kernel kernel(program, "fm_oscillator");
+    cl::Kernel inc_kernel(program, "fm_inc_table");
+    cl::Kernel sums_kernel(program, "fm_block_sums");
+    cl::Kernel scan_kernel(program, "fm_block_scan");
+    cl::Kernel mix_kernel(program, "fm_render_mix");
+
+    // One block in flight: device buffers, the host copy of its result and
+    // the events of its commands
+    struct BlockSet {
+        cl::Buffer output_buf;       // Serial path: every oscillator's row
+        cl::Buffer block_phase_buf;  // Data-parallel path: piece start phases
+        cl::Buffer mixed_buf;        // Data-parallel path: the device mix
+        std::vector<float> outputs;
+        std::vector<float> mixed;
+        std::vector<cl::Event> kernel_events;
+        cl::Event read_event;
+        bool serial = false;
+        int n = 0;
+    };
 
-    // Buffers
-    std::vector<float> outputs(num_oscillators * num_samples, 0.0f);  // All oscillators' signals
-    cl::Buffer output_buf(context, CL_MEM_WRITE_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * outputs.size(), outputs.data());
+    // Buffers, all sized by the block
+    const int max_pieces = (block_samples + FM_BLOCK_SAMPLES - 1) / FM_BLOCK_SAMPLES;
+    std::vector<BlockSet> sets(PIPELINE_SETS);
+    for (BlockSet& set : sets) {
+        set.output_buf = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(float) * num_oscillators * block_samples);
+        set.block_phase_buf = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cl_uint) * num_oscillators * max_pieces);
+        set.mixed_buf = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(float) * block_samples);
+        set.outputs.resize(num_oscillators * block_samples);  // One block of every oscillator
+        set.mixed.resize(block_samples);
+    }
+    std::vector<int16_t> stereo_signal(block_samples * 2);
+    const std::vector<cl_uint> zero_state(2 * num_oscillators, 0);
     cl::Buffer lfo_freqs_buf(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * lfo_freqs.size(), lfo_freqs.data());
     cl::Buffer sine_table_buf(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * sine_table.size(), sine_table.data());
+    cl::Buffer state_buf(context, CL_MEM_READ_WRITE, sizeof(cl_uint) * zero_state.size());
+    cl::Buffer phase_buf(context, CL_MEM_READ_WRITE, sizeof(cl_uint) * num_oscillators);
+    cl::Buffer inc_table_buf(context, CL_MEM_READ_WRITE, sizeof(cl_uint) * SINE_TABLE_SIZE);
 
-    // Launch kernels (one per oscillator)
-    for (int osc = 0; osc < num_oscillators; ++osc) {
-        kernel.setArg(0, output_buf);
-        kernel.setArg(1, lfo_freqs_buf);
-        kernel.setArg(2, sine_table_buf);
-        kernel.setArg(3, base_freq);
-        kernel.setArg(4, mod_depth);
-        kernel.setArg(5, sample_rate);
-        kernel.setArg(6, num_samples);
-        kernel.setArg(7, SINE_TABLE_SIZE);
-        kernel.setArg(8, osc);
+    kernel.setArg(1, lfo_freqs_buf);
+    kernel.setArg(2, sine_table_buf);
+    kernel.setArg(3, base_freq);
+    kernel.setArg(4, mod_depth);
+    kernel.setArg(5, sample_rate);
+    kernel.setArg(7, SINE_TABLE_SIZE);
+    kernel.setArg(9, state_buf);
 
-        queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1));
-    }
-    queue.finish();
+    inc_kernel.setArg(0, inc_table_buf);
+    inc_kernel.setArg(1, sine_table_buf);
+    inc_kernel.setArg(2, base_freq);
+    inc_kernel.setArg(3, mod_depth);
+    inc_kernel.setArg(4, sample_rate);
+    inc_kernel.setArg(5, SINE_TABLE_SIZE);
+    queue.enqueueNDRangeKernel(inc_kernel, cl::NullRange, cl::NDRange(SINE_TABLE_SIZE), cl::NullRange);
+
+    sums_kernel.setArg(1, inc_table_buf);
+    sums_kernel.setArg(2, lfo_freqs_buf);
+    sums_kernel.setArg(3, sample_rate);
+    sums_kernel.setArg(5, SINE_TABLE_SIZE);
+    sums_kernel.setArg(6, num_oscillators);
+    sums_kernel.setArg(8, FM_BLOCK_SAMPLES);
+
+    scan_kernel.setArg(1, phase_buf);
+
+    mix_kernel.setArg(2, inc_table_buf);
+    mix_kernel.setArg(3, sine_table_buf);
+    mix_kernel.setArg(4, lfo_freqs_buf);
+    mix_kernel.setArg(5, sample_rate);
+    mix_kernel.setArg(7, SINE_TABLE_SIZE);
+    mix_kernel.setArg(8, num_oscillators);
+    mix_kernel.setArg(10, FM_BLOCK_SAMPLES);
 
-    // Read back
-    queue.enqueueReadBuffer(output_buf, CL_TRUE, 0, sizeof(float) * outputs.size(), outputs.data());
+    // Enqueues samples [first_sample, first_sample + n) into set without
+    // waiting: the kernels on queue, then a non-blocking read on io_queue
+    // that waits for the last kernel's event
+    auto issue = [&](BlockSet& set, long long first_sample, int n, bool use_serial) {
+        set.n = n;
+        set.serial = use_serial;
+        set.kernel_events.clear();
+        cl::Event ev;
+        if (use_serial) {
+            kernel.setArg(0, set.output_buf);
+            kernel.setArg(6, n);
+            // Launch kernels (one per oscillator)
+            for (int osc = 0; osc < num_oscillators; ++osc) {
+                kernel.setArg(8, osc);
+                queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, &ev);
+                set.kernel_events.push_back(ev);
+            }
+        } else {
+            const int num_pieces = (n + FM_BLOCK_SAMPLES - 1) / FM_BLOCK_SAMPLES;
+            const cl_uint first = static_cast<cl_uint>(first_sample);  // The LFO phase wraps mod 2^32 anyway
+            sums_kernel.setArg(0, set.block_phase_buf);
+            sums_kernel.setArg(4, n);
+            sums_kernel.setArg(7, first);
+            queue.enqueueNDRangeKernel(sums_kernel, cl::NullRange, cl::NDRange(num_pieces), cl::NullRange, nullptr, &ev);
+            set.kernel_events.push_back(ev);
+            scan_kernel.setArg(0, set.block_phase_buf);
+            scan_kernel.setArg(2, num_pieces);
+            queue.enqueueNDRangeKernel(scan_kernel, cl::NullRange, cl::NDRange(num_oscillators), cl::NullRange, nullptr, &ev);
+            set.kernel_events.push_back(ev);
+            mix_kernel.setArg(0, set.mixed_buf);
+            mix_kernel.setArg(1, set.block_phase_buf);
+            mix_kernel.setArg(6, n);
+            mix_kernel.setArg(9, first);
+            queue.enqueueNDRangeKernel(mix_kernel, cl::NullRange, cl::NDRange(num_pieces), cl::NullRange, nullptr, &ev);
+            set.kernel_events.push_back(ev);
+        }
+        const std::vector<cl::Event> computed = {set.kernel_events.back()};
+        if (use_serial) {
+            io_queue.enqueueReadBuffer(set.output_buf, CL_FALSE, 0, sizeof(float) * num_oscillators * n, set.outputs.data(), &computed, &set.read_event);
+        } else {
+            io_queue.enqueueReadBuffer(set.mixed_buf, CL_FALSE, 0, sizeof(float) * n, set.mixed.data(), &computed, &set.read_event);
+        }
+        queue.flush();
+        io_queue.flush();
+    };
 
-    // Mix and normalize
-    std::vector<float> mixed_signal(num_samples, 0.0f);
-    for (int sample = 0; sample < num_samples; ++sample) {
-        for (int osc = 0; osc < num_oscillators; ++osc) {
-            mixed_signal[sample] += outputs[osc * num_samples + sample];
+    // Waits for set's readback and leaves its mix in set.mixed
+    auto collect = [&](BlockSet& set) {
+        set.read_event.wait();
+        if (set.serial) {
+            // Mix
+            for (int sample = 0; sample < set.n; ++sample) {
+                float mix = 0.0f;
+                for (int osc = 0; osc < num_oscillators; ++osc) {
+                    mix += set.outputs[osc * set.n + sample];
+                }
+                set.mixed[sample] = mix / num_oscillators;
+            }
         }
-        mixed_signal[sample] /= num_oscillators;
-    }
+    };
+
+    auto reset_state = [&]() {
+        queue.enqueueWriteBuffer(state_buf, CL_TRUE, 0, sizeof(cl_uint) * zero_state.size(), zero_state.data());
+        queue.enqueueWriteBuffer(phase_buf, CL_TRUE, 0, sizeof(cl_uint) * num_oscillators, zero_state.data());
+    };
+
+    auto event_seconds = [](const cl::Event& ev) {
+        return (ev.getProfilingInfo<CL_PROFILING_COMMAND_END>() - ev.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1e-9;
+    };
 
-    // Stereo output (duplicate)
-    std::vector<int16_t> stereo_signal(num_samples * 2);
-    float max_abs = 0.0f;
-    for (float val : mixed_signal) {
-        max_abs = std::max(max_abs, std::abs(val));
+    const long long num_blocks = (num_samples + block_samples - 1) / block_samples;
+    double t_compute = 0.0, t_read = 0.0, t_host = 0.0, t_wall = 0.0;
+
+    // Streams every block through the pipeline and hands each mix, in
+    // order, to consume(mixed, n). Block b is consumed after b + 1 ... b +
+    // PIPELINE_SETS - 1 have been issued, so its set is free again by the
+    // time block b + PIPELINE_SETS reuses it.
+    auto run_pass = [&](auto consume) {
+        const int lag = PIPELINE_SETS - 1;
+        const auto t0 = std::chrono::steady_clock::now();
+        reset_state();
+        for (long long blk = 0; blk < num_blocks + lag; ++blk) {
+            if (blk < num_blocks) {
+                const long long start = blk * block_samples;
+                issue(sets[blk % PIPELINE_SETS], start, static_cast<int>(std::min<long long>(block_samples, num_samples - start)), serial);
+            }
+            if (blk >= lag) {
+                BlockSet& set = sets[(blk - lag) % PIPELINE_SETS];
+                collect(set);
+                const auto th = std::chrono::steady_clock::now();
+                consume(set.mixed.data(), set.n);
+                t_host += seconds_since(th);
+                for (const cl::Event& ev : set.kernel_events) t_compute += event_seconds(ev);
+                t_read += event_seconds(set.read_event);
+            }
+        }
+        t_wall += seconds_since(t0);
+    };
+
+    queue.finish();
+    const double startup_seconds = seconds_since(t_launch);
+
+    // Verification pass (not timed): every block both ways, one at a time
+    long long verify_mismatches = 0;
+    if (verify) {
+        reset_state();
+        for (long long start = 0; start < num_samples; start += block_samples) {
+            const int n = static_cast<int>(std::min<long long>(block_samples, num_samples - start));
+            issue(sets[0], start, n, true);
+            issue(sets[1], start, n, false);
+            collect(sets[0]);
+            collect(sets[1]);
+            for (int i = 0; i < n; ++i) {
+                if (std::memcmp(&sets[0].mixed[i], &sets[1].mixed[i], sizeof(float)) != 0) verify_mismatches++;
+            }
+        }
     }
-    for (int i = 0; i < num_samples; ++i) {
-        int16_t sample_val = static_cast<int16_t>((mixed_signal[i] / max_abs) * 32767);
-        stereo_signal[2 * i] = sample_val;      // Left
-        stereo_signal[2 * i + 1] = sample_val;  // Right
+
+    // Peak pass: the blocks are rendered and dropped, keeping only max |x|
+    float max_abs = 1.0f;  // Each oscillator is a table sine, so |mix| <= 1
+    if (!fixed_gain) {
+        max_abs = 0.0f;
+        run_pass([&](const float* mixed, int n) {
+            for (int i = 0; i < n; ++i) {
+                max_abs = std::max(max_abs, std::abs(mixed[i]));
+            }
+        });
+        if (max_abs == 0.0f) max_abs = 1.0f;
     }
 
-    // Save WAV (simple header + data)
-    std::ofstream wav_file("output.wav", std::ios::binary);
-    if (!wav_file) {
+    // Save WAV (simple header + data), one block at a time
+    WavWriter wav_file;
+    if (!wav_file.open("output.wav")) {
         std::cerr << "Failed to open output.wav" << std::endl;
         return 1;
     }
-    // WAV header (44 bytes)
-    const char* header = "RIFF----WAVEfmt \x10\x00\x00\x00\x01\x00\x02\x00\x44\xAC\x00\x00\x10\xB1\x02\x00\x04\x00\x10\x00data----";
-    wav_file.write(header, 44);
-    // Update sizes
-    int file_size = 36 + sizeof(int16_t) * stereo_signal.size();
-    wav_file.seekp(4);
-    wav_file.write(reinterpret_cast<const char*>(&file_size), 4);
-    int data_size = sizeof(int16_t) * stereo_signal.size();
-    wav_file.seekp(40);
-    wav_file.write(reinterpret_cast<const char*>(&data_size), 4);
-    // Write data
-    wav_file.write(reinterpret_cast<const char*>(stereo_signal.data()), data_size);
+    bool write_ok = true;
+    run_pass([&](const float* mixed, int n) {
+        // Normalize to 16-bit stereo (duplicate)
+        for (int i = 0; i < n; ++i) {
+            int16_t sample_val = static_cast<int16_t>((mixed[i] / max_abs) * 32767);
+            stereo_signal[2 * i] = sample_val;      // Left
+            stereo_signal[2 * i + 1] = sample_val;  // Right
+        }
+        if (write_ok) write_ok = wav_file.append(stereo_signal.data(), n);
+    });
+    if (!write_ok) {
+        std::cerr << "Failed to write output.wav (WAV data is limited to 4 GiB)" << std::endl;
+        return 1;
+    }
+    if (!wav_file.close()) {
+        std::cerr << "Failed to finalize output.wav" << std::endl;
+        return 1;
+    }
 
+    const int passes = fixed_gain ? 1 : 2;
+    const size_t host_bytes = sizeof(float) * PIPELINE_SETS * (sets[0].outputs.size() + sets[0].mixed.size()) + sizeof(int16_t) * stereo_signal.size();
     std::cout << "Audio signal generated and saved as 'output.wav'" << std::endl;
+    std::cout << "  device " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+    std::cout << "  startup " << startup_seconds << " s, program " << (from_cache ? "loaded from cache" : "built from source")
+              << " in " << build_seconds << " s" << (cache_dir.empty() ? " (cache off)" : "") << std::endl;
+    std::cout << "  " << num_samples << " samples (" << duration << " s), " << passes << (passes == 1 ? " pass" : " passes")
+              << " in " << t_wall << " s: " << passes * num_samples / t_wall / 1e6 << " Msamples/s rendered, "
+              << duration / t_wall << "x real time" << std::endl;
+    std::cout << "  busy: device compute " << t_compute << " s, readback " << t_read << " s, host mix/convert/write "
+              << t_host << " s; overlap " << (t_compute + t_read + t_host) / t_wall << "x" << std::endl;
+    if (serial) {
+        std::cout << "  serial kernel, " << num_oscillators << " work-items per block" << std::endl;
+    } else {
+        std::cout << "  data-parallel kernels, " << max_pieces << " work-items per block" << std::endl;
+    }
+    std::cout << "  block " << block_samples << " samples x " << PIPELINE_SETS << " sets, host buffers " << host_bytes / 1024 << " KiB" << std::endl;
+    if (verify) {
+        std::cout << "  verify: " << verify_mismatches << " of " << num_samples << " samples differ between the serial and data-parallel paths" << std::endl;
+    }
     return 0;
 }
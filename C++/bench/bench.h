@@ -0,0 +1,256 @@
+// Shared helpers for the host-side benchmarks in C++/bench.
+// Timing, repetition and reporting (human-readable table + JSON) live here so
+// that every benchmark executable prints results in the same format.
+
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+inline double now_seconds() {
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+// One measured configuration. `outputs` is the number of samples (or pixels,
+// grains, ...) produced by a single repetition.
+struct Result {
+    std::string name;
+    std::string source;
+    std::string unit;
+    long long outputs = 0;
+    int reps = 0;
+    double best_s = 0.0;
+    double median_s = 0.0;
+    std::vector<std::pair<std::string, double>> extra;  // Benchmark-specific metrics
+
+    double outputs_per_sec() const { return best_s > 0.0 ? outputs / best_s : 0.0; }
+    double ns_per_output() const { return outputs > 0 ? best_s * 1e9 / outputs : 0.0; }
+};
+
+// Runs `fn` once to warm up and then `reps` times. `fn` returns the number of
+// outputs it produced; the best and median wall time are recorded.
+inline Result measure(const std::string& name, const std::string& source, const std::string& unit,
+                      int reps, const std::function<long long()>& fn) {
+    Result r;
+    r.name = name;
+    r.source = source;
+    r.unit = unit;
+    r.reps = reps;
+    fn();
+    std::vector<double> times;
+    for (int i = 0; i < reps; ++i) {
+        double t0 = now_seconds();
+        r.outputs = fn();
+        times.push_back(now_seconds() - t0);
+    }
+    std::sort(times.begin(), times.end());
+    r.best_s = times.front();
+    r.median_s = times[times.size() / 2];
+    return r;
+}
+
+// L2 references and misses of the calling thread over a region, from the
+// Intel L2_RQSTS events (0x24: umask 0xff references, 0x3f misses) through
+// perf_event_open. available() is false where there is no PMU access (other
+// vendors, VMs without a virtual PMU, perf_event_paranoid > 2); callers then
+// leave the miss rate out of their report.
+class L2Counters {
+public:
+    L2Counters() {
+        refs_ = open_raw(0xff24);
+        misses_ = refs_ >= 0 ? open_raw(0x3f24) : -1;
+    }
+    ~L2Counters() {
+#ifdef __linux__
+        if (refs_ >= 0) close(refs_);
+        if (misses_ >= 0) close(misses_);
+#endif
+    }
+    L2Counters(const L2Counters&) = delete;
+    L2Counters& operator=(const L2Counters&) = delete;
+
+    bool available() const { return refs_ >= 0 && misses_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (!available()) return;
+        ioctl(refs_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(misses_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(refs_, PERF_EVENT_IOC_ENABLE, 0);
+        ioctl(misses_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Misses over references since start(), 0 when unavailable
+    double stop() {
+#ifdef __linux__
+        if (!available()) return 0.0;
+        ioctl(refs_, PERF_EVENT_IOC_DISABLE, 0);
+        ioctl(misses_, PERF_EVENT_IOC_DISABLE, 0);
+        long long refs = 0, misses = 0;
+        if (read(refs_, &refs, sizeof(refs)) != sizeof(refs) || read(misses_, &misses, sizeof(misses)) != sizeof(misses)) {
+            return 0.0;
+        }
+        return refs > 0 ? (double)misses / refs : 0.0;
+#else
+        return 0.0;
+#endif
+    }
+
+private:
+    static int open_raw(unsigned long long config) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_RAW;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)config;
+        return -1;
+#endif
+    }
+
+    int refs_ = -1;
+    int misses_ = -1;
+};
+
+inline std::string format_rate(double per_sec, const std::string& unit) {
+    char buf[64];
+    if (per_sec >= 1e6) std::snprintf(buf, sizeof(buf), "%.3f M%s/s", per_sec / 1e6, unit.c_str());
+    else if (per_sec >= 1e3) std::snprintf(buf, sizeof(buf), "%.3f k%s/s", per_sec / 1e3, unit.c_str());
+    else std::snprintf(buf, sizeof(buf), "%.3f %s/s", per_sec, unit.c_str());
+    return buf;
+}
+
+inline void print_table(FILE* f, const std::vector<Result>& results) {
+    std::fprintf(f, "%-34s %-14s %12s %24s %14s  %s\n", "benchmark", "source", "outputs", "rate", "ns/output", "extra");
+    for (const Result& r : results) {
+        std::string extra;
+        for (const auto& kv : r.extra) {
+            char buf[96];
+            std::snprintf(buf, sizeof(buf), "%s%s=%g", extra.empty() ? "" : " ", kv.first.c_str(), kv.second);
+            extra += buf;
+        }
+        std::fprintf(f, "%-34s %-14s %12lld %24s %14.2f  %s\n", r.name.c_str(), r.source.c_str(), r.outputs,
+                     format_rate(r.outputs_per_sec(), r.unit).c_str(), r.ns_per_output(), extra.c_str());
+    }
+}
+
+inline std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+inline void write_json(FILE* f, const std::vector<Result>& results) {
+    std::fprintf(f, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f,
+                     "    {\"name\": \"%s\", \"source\": \"%s\", \"unit\": \"%s\", \"outputs\": %lld, \"reps\": %d, "
+                     "\"best_s\": %.9g, \"median_s\": %.9g, \"outputs_per_sec\": %.9g, \"ns_per_output\": %.9g",
+                     json_escape(r.name).c_str(), json_escape(r.source).c_str(), json_escape(r.unit).c_str(),
+                     r.outputs, r.reps, r.best_s, r.median_s, r.outputs_per_sec(), r.ns_per_output());
+        for (const auto& kv : r.extra) {
+            std::fprintf(f, ", \"%s\": %.9g", json_escape(kv.first).c_str(), kv.second);
+        }
+        std::fprintf(f, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+// Writes the JSON report to `path` ("-" for stdout). Returns false on I/O error.
+inline bool write_json_file(const std::string& path, const std::vector<Result>& results) {
+    if (path == "-") {
+        write_json(stdout, results);
+        return true;
+    }
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return false;
+    }
+    write_json(f, results);
+    std::fclose(f);
+    return true;
+}
+
+// Minimal command line handling shared by the benchmark mains:
+//   --reps N      timed repetitions per case (default 5)
+//   --scale F     multiply the default workload size
+//   --filter S    only run cases whose name contains S
+//   --json PATH   also write the JSON report to PATH ("-" = stdout)
+//   --threads N   worker threads for the multi-threaded cases (0 = all cores)
+struct Options {
+    int reps = 5;
+    int threads = 0;
+    double scale = 1.0;
+    std::string filter;
+    std::string json_path;
+
+    bool parse(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            const char* a = argv[i];
+            const bool has_val = i + 1 < argc;
+            if (!std::strcmp(a, "--reps") && has_val) reps = std::max(1, std::atoi(argv[++i]));
+            else if (!std::strcmp(a, "--scale") && has_val) scale = std::atof(argv[++i]);
+            else if (!std::strcmp(a, "--filter") && has_val) filter = argv[++i];
+            else if (!std::strcmp(a, "--json") && has_val) json_path = argv[++i];
+            else if (!std::strcmp(a, "--threads") && has_val) threads = std::max(0, std::atoi(argv[++i]));
+            else {
+                std::fprintf(stderr, "usage: %s [--reps N] [--scale F] [--filter S] [--json PATH] [--threads N]\n",
+                             argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool selected(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    long long scaled(long long n) const { return std::max(1LL, (long long)(n * scale)); }
+
+    int thread_count() const {
+        return threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    }
+};
+
+// Prints the table on stdout and the JSON report wherever --json points.
+inline int report(const Options& opt, const std::vector<Result>& results) {
+    if (opt.json_path != "-") print_table(stdout, results);
+    if (!opt.json_path.empty() && !write_json_file(opt.json_path, results)) return 1;
+    return 0;
+}
+
+} // namespace bench
+
+#endif // BENCH_BENCH_H
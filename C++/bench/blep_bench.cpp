@@ -0,0 +1,302 @@
+// Band-limited saws (dsp/blep.h, Saw and SawBank in C++/6.cpp) against the
+// naive saw rendered at 4x and 8x and decimated, the workaround they replace.
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/blep_bench.cpp -o blep_bench
+//
+// Cases (NUM_OSC saws spread over 30..2000 Hz, 1 s of audio; outputs are
+// saw samples at 44.1 kHz):
+//   saw_naive          the old Saw::process ramp at 1x
+//   saw_os4            the ramp at 4x through a 64-tap polyphase decimator
+//   saw_os8            the ramp at 8x through a 128-tap decimator: the lowest
+//                      oversampling that reaches PolyBLEP's aliasing level
+//   saw_polyblep       Saw::process, one saw at a time
+//   saw_polyblep_bank  SawBank<NUM_OSC>::render, all saws per vector step,
+//                      frequencies set per 32-sample control block
+//   square_naive       the +-1 square on blep::Oscillator's phase
+//   square_polyblep    blep::square
+//   triangle_naive     the triangle straight from the phase
+//   triangle_polyblamp blep::triangle
+// Extras: aliasing in dB, the power between the harmonics in 0..20 kHz over
+// the harmonic power (Blackman-Harris, 2^16 points). The worst of 440 Hz,
+// 1 kHz and 2 kHz is given. Also the speedup over the 4x and 8x
+// cases (saws) and, for the bank, the max difference to Saw.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace k6 {
+#include "../6.cpp"
+}
+
+namespace {
+
+const double kSampleRate = 44100.0;
+const int kOsc = NUM_OSC;
+const double kTestFreqs[] = {440.0, 1000.0, 2000.0};
+const int kAliasPoints = 1 << 16;
+const int kControlBlock = 32;
+
+void fft(std::vector<std::complex<double>>& a) {
+    const int n = (int)a.size();
+    for (int i = 1, j = 0; i < n; ++i) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        const std::complex<double> step = std::polar(1.0, -2.0 * M_PI / len);
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w = 1.0;
+            for (int j = 0; j < len / 2; ++j) {
+                const std::complex<double> u = a[i + j], v = a[i + j + len / 2] * w;
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+                w *= step;
+            }
+        }
+    }
+}
+
+// Power off the harmonics of f0 over power on them, 0..20 kHz, in dB
+double alias_db(const std::vector<float>& x, double f0) {
+    const int n = (int)x.size();
+    std::vector<std::complex<double>> a(n);
+    for (int i = 0; i < n; ++i) {
+        const double t = 2.0 * M_PI * i / n;
+        a[i] = x[i] * (0.35875 - 0.48829 * std::cos(t) + 0.14128 * std::cos(2 * t) - 0.01168 * std::cos(3 * t));
+    }
+    fft(a);
+    const double bin_hz = kSampleRate / n;
+    double harmonic = 0.0, alias = 0.0;
+    for (int b = 1; b * bin_hz <= 20000.0; ++b) {
+        const double f = b * bin_hz;
+        const double k = std::round(f / f0);
+        // The window main lobe is 4 bins either side; 6 leaves margin
+        if (k >= 1.0 && std::fabs(f - k * f0) <= 6.0 * bin_hz) harmonic += std::norm(a[b]);
+        else alias += std::norm(a[b]);
+    }
+    return 10.0 * std::log10(alias / harmonic);
+}
+
+// The ramp Saw::process produced before PolyBLEP, at a given rate
+struct NaiveSaw {
+    float phase = 0.0f;
+    float inc = 0.0f;
+    float next() {
+        const float out = phase * 2.0f - 1.0f;
+        phase += inc;
+        if (phase > 1.0f) phase -= 1.0f;
+        return out;
+    }
+};
+
+// Naive saws at Factor x rate, Blackman-windowed sinc lowpass at 21 kHz,
+// only every Factor-th output computed
+template <int Factor>
+class Oversampled {
+public:
+    explicit Oversampled(int taps) : h_(taps), hist_(kOsc, std::vector<float>(2 * taps)), pos_(0) {
+        const double fc = 21000.0 / (kSampleRate * Factor);
+        double sum = 0.0;
+        for (int i = 0; i < taps; ++i) {
+            const double m = i - (taps - 1) / 2.0;
+            const double sinc = m == 0.0 ? 2.0 * fc : std::sin(2.0 * M_PI * fc * m) / (M_PI * m);
+            const double w = 0.42 - 0.5 * std::cos(2.0 * M_PI * i / (taps - 1)) + 0.08 * std::cos(4.0 * M_PI * i / (taps - 1));
+            h_[i] = (float)(sinc * w);
+            sum += h_[i];
+        }
+        for (float& c : h_) c = (float)(c / sum);
+        saws_.resize(kOsc);
+    }
+
+    void set_freq(int osc, double hz) { saws_[osc].inc = (float)(hz / (kSampleRate * Factor)); }
+
+    // One output sample per saw
+    void process(float* out) {
+        const int taps = (int)h_.size();
+        for (int o = 0; o < kOsc; ++o) {
+            // History is doubled so the taps read one contiguous window
+            std::vector<float>& hist = hist_[o];
+            for (int k = 0; k < Factor; ++k) {
+                const float s = saws_[o].next();
+                hist[(pos_ + k) % taps] = s;
+                hist[(pos_ + k) % taps + taps] = s;
+            }
+            const float* window = &hist[(pos_ + Factor) % taps];
+            float acc = 0.0f;
+            for (int i = 0; i < taps; ++i) acc += h_[i] * window[i];
+            out[o] = acc;
+        }
+        pos_ = (pos_ + Factor) % taps;
+    }
+
+private:
+    std::vector<float> h_;
+    std::vector<std::vector<float>> hist_;
+    std::vector<NaiveSaw> saws_;
+    int pos_;
+};
+
+double osc_freq(int osc) { return 30.0 + (2000.0 - 30.0) * osc / (kOsc - 1); }
+
+// Each renderer fills out[s * kOsc + o] for n samples of the kOsc saws (or
+// of one saw at freq when single is set, for the alias measurement)
+void render_naive(std::vector<float>& out, int n, double single = 0.0) {
+    const int m = single > 0.0 ? 1 : kOsc;
+    std::vector<NaiveSaw> saws(m);
+    for (int o = 0; o < m; ++o) saws[o].inc = (float)((single > 0.0 ? single : osc_freq(o)) / kSampleRate);
+    for (int s = 0; s < n; ++s) {
+        for (int o = 0; o < m; ++o) out[s * m + o] = saws[o].next();
+    }
+}
+
+template <int Factor>
+void render_oversampled(std::vector<float>& out, int n, int taps, double single = 0.0) {
+    Oversampled<Factor> os(taps);
+    float frame[kOsc];
+    for (int o = 0; o < kOsc; ++o) os.set_freq(o, single > 0.0 ? single : osc_freq(o));
+    for (int s = 0; s < n; ++s) {
+        os.process(frame);
+        if (single > 0.0) out[s] = frame[0];
+        else std::copy(frame, frame + kOsc, &out[s * kOsc]);
+    }
+}
+
+void render_polyblep(std::vector<float>& out, int n, double single = 0.0) {
+    const int m = single > 0.0 ? 1 : kOsc;
+    std::vector<k6::Saw> saws(m);
+    for (int o = 0; o < m; ++o) saws[o].freq = (float)(single > 0.0 ? single : osc_freq(o));
+    for (int s = 0; s < n; ++s) {
+        for (int o = 0; o < m; ++o) out[s * m + o] = saws[o].process();
+    }
+}
+
+void render_bank(std::vector<float>& out, int n) {
+    k6::SawBank<kOsc> bank;
+    float freq[kOsc];
+    for (int o = 0; o < kOsc; ++o) freq[o] = (float)osc_freq(o);
+    for (int s = 0; s < n; s += kControlBlock) bank.render(freq, &out[s * kOsc], std::min(kControlBlock, n - s));
+}
+
+// Square and triangle through a blep::Oscillator, same layout as the saws
+typedef float (*ShapeFn)(float t, float dt);
+
+float square_naive(float t, float) { return t < 0.5f ? 1.0f : -1.0f; }
+float square_polyblep(float t, float dt) { return blep::square(t, dt); }
+float triangle_naive(float t, float) { return 1.0f - 4.0f * (t < 0.5f ? 0.5f - t : t - 0.5f); }
+float triangle_polyblamp(float t, float dt) { return blep::triangle(t, dt); }
+
+void render_shape(ShapeFn shape, std::vector<float>& out, int n, double single = 0.0) {
+    const int m = single > 0.0 ? 1 : kOsc;
+    std::vector<blep::Oscillator> oscs(m);
+    for (int o = 0; o < m; ++o) oscs[o].inc = (float)((single > 0.0 ? single : osc_freq(o)) / kSampleRate);
+    for (int s = 0; s < n; ++s) {
+        for (int o = 0; o < m; ++o) {
+            blep::Oscillator& osc = oscs[o];
+            out[s * m + o] = shape(osc.phase, osc.inc);
+            osc.phase = blep::wrap(osc.phase + osc.inc);
+        }
+    }
+}
+
+template <typename Render>
+double worst_alias(Render render) {
+    std::vector<float> x(kAliasPoints);
+    double worst = -1e9;
+    for (double f0 : kTestFreqs) {
+        render(x, f0);
+        worst = std::max(worst, alias_db(x, f0));
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    const int n = (int)opt.scaled((long long)kSampleRate);
+    const long long outputs = (long long)n * kOsc;
+    std::vector<float> out(n * kOsc), ref(n * kOsc);
+    std::vector<bench::Result> results;
+
+    bench::Result r4 = bench::measure("saw_os4", "C++/6.cpp", "samples", opt.reps, [&]() {
+        render_oversampled<4>(out, n, 64);
+        return outputs;
+    });
+    r4.extra.push_back({"alias_db", worst_alias([](std::vector<float>& x, double f) {
+        render_oversampled<4>(x, (int)x.size(), 64, f);
+    })});
+    bench::Result r8 = bench::measure("saw_os8", "C++/6.cpp", "samples", opt.reps, [&]() {
+        render_oversampled<8>(out, n, 128);
+        return outputs;
+    });
+    r8.extra.push_back({"alias_db", worst_alias([](std::vector<float>& x, double f) {
+        render_oversampled<8>(x, (int)x.size(), 128, f);
+    })});
+    auto add_speedups = [&](bench::Result& r) {
+        r.extra.push_back({"speedup_vs_os4", r4.best_s / r.best_s});
+        r.extra.push_back({"speedup_vs_os8", r8.best_s / r.best_s});
+    };
+
+    if (opt.selected("saw_naive")) {
+        bench::Result r = bench::measure("saw_naive", "C++/6.cpp", "samples", opt.reps, [&]() {
+            render_naive(out, n);
+            return outputs;
+        });
+        r.extra.push_back({"alias_db", worst_alias([](std::vector<float>& x, double f) { render_naive(x, (int)x.size(), f); })});
+        results.push_back(r);
+    }
+    if (opt.selected("saw_os4")) results.push_back(r4);
+    if (opt.selected("saw_os8")) results.push_back(r8);
+
+    if (opt.selected("saw_polyblep") || opt.selected("saw_polyblep_bank")) {
+        bench::Result r = bench::measure("saw_polyblep", "C++/6.cpp", "samples", opt.reps, [&]() {
+            render_polyblep(ref, n);
+            return outputs;
+        });
+        r.extra.push_back({"alias_db", worst_alias([](std::vector<float>& x, double f) { render_polyblep(x, (int)x.size(), f); })});
+        add_speedups(r);
+        if (opt.selected("saw_polyblep")) results.push_back(r);
+    }
+    if (opt.selected("saw_polyblep_bank")) {
+        bench::Result r = bench::measure("saw_polyblep_bank", "C++/6.cpp", "samples", opt.reps, [&]() {
+            render_bank(out, n);
+            return outputs;
+        });
+        add_speedups(r);
+        double diff = 0.0;
+        for (size_t i = 0; i < out.size(); ++i) diff = std::max(diff, (double)std::fabs(out[i] - ref[i]));
+        r.extra.push_back({"max_diff_vs_saw", diff});
+        results.push_back(r);
+    }
+
+    const struct {
+        const char* name;
+        ShapeFn shape;
+    } shapes[] = {{"square_naive", square_naive}, {"square_polyblep", square_polyblep},
+                  {"triangle_naive", triangle_naive}, {"triangle_polyblamp", triangle_polyblamp}};
+    for (const auto& c : shapes) {
+        if (!opt.selected(c.name)) continue;
+        const ShapeFn shape = c.shape;
+        bench::Result r = bench::measure(c.name, "dsp/blep.h", "samples", opt.reps, [&]() {
+            render_shape(shape, out, n);
+            return outputs;
+        });
+        r.extra.push_back({"alias_db", worst_alias([shape](std::vector<float>& x, double f) {
+            render_shape(shape, x, (int)x.size(), f);
+        })});
+        results.push_back(r);
+    }
+
+    return bench::report(opt, results);
+}
@@ -0,0 +1,251 @@
+// Reverb delay lines: the integer-% circular buffers the reverbs used against
+// the power-of-two lines of dsp/delay.h, in float, Q2.13 and bfloat16 storage,
+// with each voice's lines inside the voice or carved from one huge-page arena
+// (host/arena.h).
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/delay_bench.cpp -o delay_bench
+//
+// Cases (0.5 s of audio per voice, --scale multiplies it; outputs are comb
+// samples; voices render in turn in 64-sample blocks, as in a voice mixer):
+//   drone/vN/VARIANT     N voices of the six 10000-sample combs of
+//                        SimpleReverb (C++/6.cpp), N = 1, 32
+//   freeverb/vN/VARIANT  N voices of the stereo 1000-sample comb pair of
+//                        the former SimpleFreeVerb (C++/12.cpp), N = 32, 256
+// VARIANT: mod (buffer[len], idx % len), pow2_f32, pow2_q2_13, pow2_bf16
+// (delay::FixedDelay in each voice), arena_f32, arena_bf16 (delay::DelayLine
+// carved from one host::Arena). The comb bodies are those of the kernels
+// (freeverb_bench covers the full Freeverb that replaced SimpleFreeVerb).
+// Extras: delay state in KB, the L2 miss rate where the PMU is readable
+// (see bench::L2Counters), whether the arena got huge pages, the speedup
+// over mod and the max output difference to it relative to the output peak.
+// The float lines give the same samples as mod; they differ only where the
+// compiler fuses multiply-adds differently (0 with -ffp-contract=off).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+#include "../host/arena.h"
+
+namespace {
+
+const int kBlock = 64;
+const int kDroneLen = 10000;
+const int kDroneCombs = 6;
+const int kVerbLen = 1000;
+
+// The circular buffer the reverbs used before dsp/delay.h
+template <int Len>
+class ModLine {
+public:
+    float read(uint32_t d) const { return buffer_[(idx_ + Len - d) % Len]; }
+    void write(float x) {
+        buffer_[idx_] = x;
+        idx_ = (idx_ + 1) % Len;
+    }
+
+private:
+    float buffer_[Len] = {};
+    int idx_ = 0;
+};
+
+// SimpleReverb::process
+template <int Len, typename Line>
+inline float drone_comb(Line& line, float in) {
+    const float room = 0.5f, damp = 0.6f;
+    const float out = line.read(Len);
+    line.write(in + out * room);
+    return out * (1.0f - damp) + in * 0.8f;
+}
+
+// The former SimpleFreeVerb::process at its default parameters, without the control
+// rate ramps
+template <int Len, typename Line>
+inline void freeverb(Line* lines, float& left, float& right) {
+    const float comb = 0.6f, damp_coeff = 0.7f, wet = 0.4f;
+    const float input = (left + right) * 0.5f;
+    float out[2];
+    for (int ch = 0; ch < 2; ++ch) {
+        const float delayed = lines[ch].read(Len);
+        const float filtered = damp_coeff * delayed + (1.0f - damp_coeff) * lines[ch].read(Len / 2);
+        lines[ch].write(input + comb * filtered);
+        out[ch] = delayed;
+    }
+    left = left * (1.0f - wet) + out[0] * wet;
+    right = right * (1.0f - wet) + out[1] * wet;
+}
+
+// A voice's lines; in the arena banks they point into the arena
+template <typename Line, int Lines>
+struct Voice {
+    Line lines[Lines];
+};
+
+template <typename Line, int Lines>
+struct Bank {
+    std::vector<std::unique_ptr<Voice<Line, Lines>>> voices;
+    std::unique_ptr<host::Arena> arena;
+    size_t state_bytes = 0;
+};
+
+template <typename Line, int Lines>
+Bank<Line, Lines> make_bank(int n) {
+    Bank<Line, Lines> bank;
+    for (int v = 0; v < n; ++v) bank.voices.emplace_back(new Voice<Line, Lines>());
+    bank.state_bytes = (size_t)n * Lines * sizeof(Line);
+    return bank;
+}
+
+template <typename Codec, int Lines, int Len>
+Bank<delay::DelayLine<Codec>, Lines> make_arena_bank(int n) {
+    Bank<delay::DelayLine<Codec>, Lines> bank;
+    const size_t per_line = host::Arena::delay_bytes<Codec>(Len);
+    bank.arena.reset(new host::Arena((size_t)n * Lines * per_line, true));
+    host::Arena& arena = *bank.arena;
+    for (int v = 0; v < n; ++v) {
+        bank.voices.emplace_back(new Voice<delay::DelayLine<Codec>, Lines>());
+        for (int l = 0; l < Lines; ++l) bank.voices.back()->lines[l] = arena.delay_line<Codec>(Len);
+    }
+    bank.state_bytes = arena.used();
+    return bank;
+}
+
+// Drone input: the six saws of the stack, fixed detune
+void drone_input(std::vector<float>& in, int frames) {
+    in.resize((size_t)frames * kDroneCombs);
+    for (int c = 0; c < kDroneCombs; ++c) {
+        float phase = 0.0f;
+        const float inc = (200.0f + 3.0f * c) / 44100.0f;
+        for (int s = 0; s < frames; ++s) {
+            in[(size_t)s * kDroneCombs + c] = phase * 2.0f - 1.0f;
+            phase += inc;
+            if (phase >= 1.0f) phase -= 1.0f;
+        }
+    }
+}
+
+template <typename Line>
+void run_drone(Bank<Line, kDroneCombs>& bank, const std::vector<float>& in, std::vector<float>& out, int frames) {
+    for (int s0 = 0; s0 < frames; s0 += kBlock) {
+        const int n = std::min(kBlock, frames - s0);
+        for (size_t v = 0; v < bank.voices.size(); ++v) {
+            Line* lines = bank.voices[v]->lines;
+            for (int s = s0; s < s0 + n; ++s) {
+                float sum = 0.0f;
+                for (int c = 0; c < kDroneCombs; ++c) sum += drone_comb<kDroneLen>(lines[c], in[(size_t)s * kDroneCombs + c]);
+                out[s] += sum;
+            }
+        }
+    }
+}
+
+template <typename Line>
+void run_freeverb(Bank<Line, 2>& bank, const std::vector<float>& in, std::vector<float>& out, int frames) {
+    for (int s0 = 0; s0 < frames; s0 += kBlock) {
+        const int n = std::min(kBlock, frames - s0);
+        for (size_t v = 0; v < bank.voices.size(); ++v) {
+            Line* lines = bank.voices[v]->lines;
+            for (int s = s0; s < s0 + n; ++s) {
+                float left = in[(size_t)s * kDroneCombs], right = in[(size_t)s * kDroneCombs + 1];
+                freeverb<kVerbLen>(lines, left, right);
+                out[s] += left + right;
+            }
+        }
+    }
+}
+
+double max_rel_diff(const std::vector<float>& a, const std::vector<float>& ref) {
+    double d = 0.0, peak = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        d = std::max(d, (double)std::fabs(a[i] - ref[i]));
+        peak = std::max(peak, (double)std::fabs(ref[i]));
+    }
+    return peak > 0.0 ? d / peak : d;
+}
+
+struct Context {
+    const bench::Options& opt;
+    bench::L2Counters& l2;
+    std::vector<bench::Result>& results;
+    const std::vector<float>& in;
+    int frames;
+};
+
+// Times one variant and returns its best time. Every variant runs the same
+// number of times from silent lines, so the last run's output lines up with
+// mod's.
+template <typename MakeBank, typename Run>
+double run_case(Context& ctx, const std::string& name, const char* source, int voices, int lines_per_voice,
+                MakeBank make_bank_fn, Run run, std::vector<float>& out, const std::vector<float>* ref,
+                double ref_best_s) {
+    auto bank = make_bank_fn();
+    double miss_rate = 0.0;
+    bench::Result r = bench::measure(name, source, "samples", ctx.opt.reps, [&]() {
+        std::fill(out.begin(), out.end(), 0.0f);
+        ctx.l2.start();
+        run(bank, ctx.in, out, ctx.frames);
+        miss_rate = ctx.l2.stop();
+        return (long long)ctx.frames * voices * lines_per_voice;
+    });
+    r.extra.push_back({"state_kb", bank.state_bytes / 1024.0});
+    if (ctx.l2.available()) r.extra.push_back({"l2_miss_rate", miss_rate});
+    if (bank.arena) r.extra.push_back({"huge_pages", std::string(bank.arena->page_kind()) != "none" ? 1.0 : 0.0});
+    if (ref) {
+        r.extra.push_back({"speedup_vs_mod", ref_best_s / r.best_s});
+        r.extra.push_back({"max_rel_diff_vs_mod", max_rel_diff(out, *ref)});
+    }
+    if (ctx.opt.selected(name)) ctx.results.push_back(r);
+    return r.best_s;
+}
+
+template <int Lines, int Len, typename Run>
+void run_workload(Context& ctx, const char* workload, const char* source, int voices, Run run) {
+    const std::string prefix = std::string(workload) + "/v" + std::to_string(voices) + "/";
+    const char* variants[] = {"mod", "pow2_f32", "pow2_q2_13", "pow2_bf16", "arena_f32", "arena_bf16"};
+    bool any = false;
+    for (const char* v : variants) any |= ctx.opt.selected(prefix + v);
+    if (!any) return;
+
+    // mod always runs: the others are compared against it
+    std::vector<float> ref(ctx.frames), out(ctx.frames);
+    const double ref_s = run_case(ctx, prefix + "mod", source, voices, Lines,
+                                  [&] { return make_bank<ModLine<Len>, Lines>(voices); }, run, ref, nullptr, 0.0);
+    run_case(ctx, prefix + "pow2_f32", source, voices, Lines,
+             [&] { return make_bank<delay::FixedDelay<Len, delay::F32>, Lines>(voices); }, run, out, &ref, ref_s);
+    run_case(ctx, prefix + "pow2_q2_13", source, voices, Lines,
+             [&] { return make_bank<delay::FixedDelay<Len, delay::Q2_13>, Lines>(voices); }, run, out, &ref, ref_s);
+    run_case(ctx, prefix + "pow2_bf16", source, voices, Lines,
+             [&] { return make_bank<delay::FixedDelay<Len, delay::BF16>, Lines>(voices); }, run, out, &ref, ref_s);
+    run_case(ctx, prefix + "arena_f32", source, voices, Lines,
+             [&] { return make_arena_bank<delay::F32, Lines, Len>(voices); }, run, out, &ref, ref_s);
+    run_case(ctx, prefix + "arena_bf16", source, voices, Lines,
+             [&] { return make_arena_bank<delay::BF16, Lines, Len>(voices); }, run, out, &ref, ref_s);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    const int frames = (int)opt.scaled(22050);
+    std::vector<float> in;
+    drone_input(in, frames);
+    bench::L2Counters l2;
+    if (!l2.available()) std::fprintf(stderr, "L2 counters unavailable here: l2_miss_rate omitted\n");
+
+    std::vector<bench::Result> results;
+    Context ctx = {opt, l2, results, in, frames};
+    auto drone = [](auto& bank, const std::vector<float>& x, std::vector<float>& y, int n) { run_drone(bank, x, y, n); };
+    auto verb = [](auto& bank, const std::vector<float>& x, std::vector<float>& y, int n) { run_freeverb(bank, x, y, n); };
+    for (int voices : {1, 32}) run_workload<kDroneCombs, kDroneLen>(ctx, "drone", "C++/6.cpp", voices, drone);
+    for (int voices : {32, 256}) run_workload<2, kVerbLen>(ctx, "freeverb", "C++/12.cpp", voices, verb);
+
+    return bench::report(opt, results);
+}
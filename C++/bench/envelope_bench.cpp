@@ -0,0 +1,223 @@
+// Envelope tables (dsp/envelope.h) against the envelope math they replace:
+// the per-grain Hann of C++/5.cpp (a division and a cosf per grain sample)
+// and the attack/release of C++/3.cpp (compare-and-add on ap_fixed<16,4> per
+// instrument), plus the interpolation error of each table shape.
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/envelope_bench.cpp -o envelope_bench
+//
+// Cases (outputs are envelope samples):
+//   hann_cosf          MAX_GRAINS overlapping grains, 0.5 * (1 - cosf(2 pi (1 - counter / dur)))
+//   hann_table         same grains, table lookup through a 32-bit phase
+//   hann_table_block   same grains, Envelope::render in 64-sample blocks
+//   perc_ap_fixed      16 instruments, the 3.cpp compare-and-add
+//   perc_table         16 instruments, one shared table lookup per sample
+// Extras: speedup over the math each table replaces, and table_error, the
+// max |table - shape| of the table the row reads (checked at 16 points per
+// step). The same error for the shapes no row uses, Tukey(0.5),
+// Gaussian(0.15) and perc(0.01, 1, -4), is printed to stderr after the table
+// (skipped by --filter unless it matches "table_error").
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace {
+
+const int kGrains = 512;
+const int kBlock = 64;
+const float kSampleRate = 44100.0f;
+const float kGrainDur = 0.02f * kSampleRate;
+const int kInstruments = 16;
+
+constexpr env::Table kHann = env::hann_table();
+constexpr env::Table kTukey = env::tukey_table(0.5);
+constexpr env::Table kGaussian = env::gaussian_table(0.15);
+constexpr env::Table kPercCurved = env::perc_table(0.01, 1.0, -4.0);
+constexpr env::Table kPerc = env::perc_table(0.01, 1.0, 0.0);
+
+// Grains start evenly staggered over one grain length, so every sample sees
+// all kGrains live; a finished grain restarts.
+float hann_cosf(std::vector<float>& out, int samples) {
+    std::vector<float> counter(kGrains);
+    for (int g = 0; g < kGrains; ++g) counter[g] = kGrainDur - g * kGrainDur / kGrains;
+    for (int s = 0; s < samples; ++s) {
+        float sum = 0.0f;
+        for (int g = 0; g < kGrains; ++g) {
+            float fraction = 1.0f - (counter[g] / kGrainDur);
+            sum += 0.5f * (1.0f - cosf(2.0f * (float)M_PI * fraction));
+            counter[g] -= 1.0f;
+            if (counter[g] <= 0.0f) counter[g] = kGrainDur;
+        }
+        out[s] = sum;
+    }
+    return out[samples - 1];
+}
+
+float hann_table(std::vector<float>& out, int samples) {
+    const uint32_t inc = env::phase_inc(kGrainDur);
+    std::vector<uint32_t> phase(kGrains);
+    for (int g = 0; g < kGrains; ++g) phase[g] = (uint32_t)((double)g / kGrains * 4294967296.0);
+    for (int s = 0; s < samples; ++s) {
+        float sum = 0.0f;
+        for (int g = 0; g < kGrains; ++g) {
+            sum += env::lookup(kHann, phase[g]);
+            phase[g] += inc;  // Wraps: the grain restarts
+        }
+        out[s] = sum;
+    }
+    return out[samples - 1];
+}
+
+float hann_table_block(std::vector<float>& out, int samples) {
+    std::vector<env::Envelope> grains;
+    for (int g = 0; g < kGrains; ++g) {
+        grains.emplace_back(kHann, kGrainDur);
+        grains.back().phase = (uint32_t)((double)g / kGrains * 4294967296.0);
+    }
+    float block[kBlock];
+    for (int s0 = 0; s0 < samples; s0 += kBlock) {
+        const int n = std::min(kBlock, samples - s0);
+        std::fill(&out[s0], &out[s0] + n, 0.0f);
+        for (env::Envelope& e : grains) {
+            e.render(block, n);
+            for (int s = 0; s < n; ++s) out[s0 + s] += block[s];
+            if (e.done()) e.trigger();
+        }
+    }
+    return out[samples - 1];
+}
+
+float perc_ap_fixed(std::vector<float>& out, int samples) {
+    ap_fixed<16,4> env[kInstruments] = {0};
+    const int trigger_rate = 44100 / 10;
+    for (int s = 0; s < samples; ++s) {
+        float sum = 0.0f;
+        for (int i = 0; i < kInstruments; ++i) {
+            if (s % trigger_rate == 0) env[i] = 0;
+            if (env[i] < 1.0) {
+                env[i] += 100.0 / 44100;
+            } else {
+                env[i] -= 1.0 / 44100;
+                if (env[i] < 0) env[i] = 0;
+            }
+            sum += env[i].to_float();
+        }
+        out[s] = sum;
+    }
+    return out[samples - 1];
+}
+
+float perc_table(std::vector<float>& out, int samples) {
+    const uint32_t inc = env::phase_inc((0.01 + 1.0) * 44100);
+    const int trigger_rate = 44100 / 10;
+    uint32_t phase = 0;
+    for (int s = 0; s < samples; ++s) {
+        if (s % trigger_rate == 0) phase = 0;
+        ap_fixed<16,4> env = env::lookup(kPerc, phase);
+        phase = env::advance(phase, inc);
+        out[s] = kInstruments * env.to_float();
+    }
+    return out[samples - 1];
+}
+
+template <typename Shape>
+double table_error(const env::Table& t, Shape shape) {
+    double err = 0.0;
+    const int steps = 16;
+    for (int i = 0; i < env::kTableSize; ++i) {
+        for (int k = 0; k < steps; ++k) {
+            const uint32_t phase = ((uint32_t)i << env::kFracBits) + (uint32_t)k * ((1u << env::kFracBits) / steps);
+            const double x = phase / 4294967296.0;
+            err = std::max(err, std::fabs(env::lookup(t, phase) - shape(x)));
+        }
+    }
+    return err;
+}
+
+double hann_shape(double x) { return 0.5 - 0.5 * std::cos(2.0 * M_PI * x); }
+
+double perc_shape(double x) {
+    const double a = 0.01 / 1.01;
+    return x < a ? x / a : 1.0 - (x - a) / (1.0 - a);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    const int samples = std::max(kBlock, (int)(44100 * opt.scale));
+    std::vector<float> out(samples), ref(samples);
+    std::vector<bench::Result> results;
+
+    if (opt.selected("hann_cosf") || opt.selected("hann_table") || opt.selected("hann_table_block")) {
+        bench::Result rc = bench::measure("hann_cosf", "C++/5.cpp", "samples", opt.reps, [&]() {
+            hann_cosf(ref, samples);
+            return (long long)samples * kGrains;
+        });
+        if (opt.selected("hann_cosf")) results.push_back(rc);
+
+        if (opt.selected("hann_table")) {
+            bench::Result r = bench::measure("hann_table", "dsp/envelope.h", "samples", opt.reps, [&]() {
+                hann_table(out, samples);
+                return (long long)samples * kGrains;
+            });
+            r.extra.push_back({"speedup", rc.best_s / r.best_s});
+            r.extra.push_back({"table_error", table_error(kHann, hann_shape)});
+            results.push_back(r);
+        }
+        if (opt.selected("hann_table_block")) {
+            bench::Result r = bench::measure("hann_table_block", "dsp/envelope.h", "samples", opt.reps, [&]() {
+                hann_table_block(out, samples);
+                return (long long)samples * kGrains;
+            });
+            r.extra.push_back({"speedup", rc.best_s / r.best_s});
+            r.extra.push_back({"table_error", table_error(kHann, hann_shape)});
+            results.push_back(r);
+        }
+    }
+
+    if (opt.selected("perc_ap_fixed") || opt.selected("perc_table")) {
+        bench::Result rf = bench::measure("perc_ap_fixed", "C++/3.cpp", "samples", opt.reps, [&]() {
+            perc_ap_fixed(ref, samples);
+            return (long long)samples * kInstruments;
+        });
+        if (opt.selected("perc_ap_fixed")) results.push_back(rf);
+
+        if (opt.selected("perc_table")) {
+            bench::Result r = bench::measure("perc_table", "dsp/envelope.h", "samples", opt.reps, [&]() {
+                perc_table(out, samples);
+                return (long long)samples * kInstruments;
+            });
+            r.extra.push_back({"speedup", rf.best_s / r.best_s});
+            r.extra.push_back({"table_error", table_error(kPerc, perc_shape)});
+            results.push_back(r);
+        }
+    }
+
+    const int status = bench::report(opt, results);
+
+    if (opt.selected("table_error")) {
+        const double tukey = table_error(kTukey, [](double x) {
+            const double t = std::min(x, 1.0 - x);
+            return t < 0.25 ? 0.5 - 0.5 * std::cos(2.0 * M_PI * t / 0.5) : 1.0;
+        });
+        const double gaussian = table_error(kGaussian, [](double x) {
+            const double u = (x - 0.5) / 0.15;
+            return std::exp(-0.5 * u * u);
+        });
+        const double perc_curved = table_error(kPercCurved, [](double x) {
+            const double a = 0.01 / 1.01, k = 1.0 / (1.0 - std::exp(-4.0));
+            if (x < a) return (1.0 - std::exp(-4.0 * x / a)) * k;
+            return 1.0 - (1.0 - std::exp(-4.0 * (x - a) / (1.0 - a))) * k;
+        });
+        std::fprintf(stderr, "table_error: tukey=%g gaussian=%g perc_curved=%g\n", tukey, gaussian, perc_curved);
+    }
+    return status;
+}
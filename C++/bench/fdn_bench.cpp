@@ -0,0 +1,179 @@
+// The shared FDN reverb bus of C++/3.cpp (dsp/fdn.h) against the
+// per-instrument loop it replaced, where each of the 16 instruments read and
+// rewrote one shared delay slot with its own multiply-add.
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/fdn_bench.cpp -o fdn_bench
+//
+// Cases (1 s of the 16 enveloped 32..47 Hz sines of synth(), precomputed, so
+// only the reverb is timed; outputs are samples):
+//   slot_loop/fixed   the old loop on a 22050-sample ap_fixed<16,4> line
+//   slot_loop/float   the same loop in float
+//   fdnN/fixed        16-into-1 send, then Fdn<N> on ap_fixed<16,4> lines,
+//                     N = 4, 8 (synth() uses N = 4)
+//   fdnN/float        the same on float lines, one sample per call
+//   fdnN/simd         float lines through the block path, 64-sample blocks
+// ap_fixed is emulated in double (C++/hls_emu), so the fixed cases count
+// operations rather than predict FPGA cost.
+// Extras: speedup over the slot loop of the same type, and for fixed and
+// simd the max difference to fdnN/float relative to its peak.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace {
+
+typedef ap_fixed<16,4> fixed_t;
+
+const int kInst = 16;
+const int kSampleRate = 44100;
+const int kSlotDelay = 22050;
+const int kBlock = 64;
+
+// The instruments of synth(): sine at 32 + i Hz under the 0.01 s / 1 s perc
+// envelope, retriggered at 10 Hz
+void make_signals(std::vector<float>& sig, int frames) {
+    sig.resize((size_t)frames * kInst);
+    for (int s = 0; s < frames; ++s) {
+        const double t = (s % (kSampleRate / 10)) / (double)kSampleRate;
+        const double env = t < 0.01 ? t / 0.01 : std::max(0.0, 1.0 - (t - 0.01));
+        for (int i = 0; i < kInst; ++i) {
+            sig[(size_t)s * kInst + i] = (float)(std::sin(2.0 * M_PI * (32 + i) * s / kSampleRate) * env);
+        }
+    }
+}
+
+// synth()'s reverb before the FDN
+template <typename T>
+void slot_loop(const std::vector<T>& sig, std::vector<float>& out, int frames) {
+    std::unique_ptr<delay::FixedDelay<kSlotDelay, delay::Raw<T>>> line(new delay::FixedDelay<kSlotDelay, delay::Raw<T>>());
+    for (int s = 0; s < frames; ++s) {
+        T sum = 0;
+        T slot = line->read(kSlotDelay);
+        for (int i = 0; i < kInst; ++i) {
+            T rev = slot;
+            slot = sig[(size_t)s * kInst + i] + rev * 0.7;
+            sum += rev / kInst;
+        }
+        line->write(slot);
+        out[s] = (float)sum;
+    }
+}
+
+// The send bus as synth() sums it: full-scale accumulator, one scale
+inline float send(const std::vector<float>& sig, int s) {
+    float bus = 0.0f;
+    for (int i = 0; i < kInst; ++i) bus += sig[(size_t)s * kInst + i];
+    return bus * (1.0f / kInst);
+}
+
+inline fixed_t send(const std::vector<fixed_t>& sig, int s) {
+    ap_fixed<20,8> bus = 0;
+    for (int i = 0; i < kInst; ++i) bus += sig[(size_t)s * kInst + i];
+    return bus / kInst;
+}
+
+template <int N, typename Codec>
+void fdn_frames(const std::vector<typename Codec::value_type>& sig, std::vector<float>& out, int frames) {
+    std::unique_ptr<fdn::Fdn<N, Codec>> reverb(new fdn::Fdn<N, Codec>(2.0f, kSampleRate));
+    for (int s = 0; s < frames; ++s) out[s] = (float)reverb->process(send(sig, s));
+}
+
+template <int N>
+void fdn_blocks(const std::vector<float>& sig, std::vector<float>& out, int frames) {
+    std::unique_ptr<fdn::Fdn<N>> reverb(new fdn::Fdn<N>(2.0f, kSampleRate));
+    float bus[kBlock];
+    for (int s0 = 0; s0 < frames; s0 += kBlock) {
+        const int n = std::min(kBlock, frames - s0);
+        for (int s = 0; s < n; ++s) bus[s] = send(sig, s0 + s);
+        reverb->process(bus, &out[s0], n);
+    }
+}
+
+double max_rel_diff(const std::vector<float>& a, const std::vector<float>& ref) {
+    double d = 0.0, peak = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        d = std::max(d, (double)std::fabs(a[i] - ref[i]));
+        peak = std::max(peak, (double)std::fabs(ref[i]));
+    }
+    return peak > 0.0 ? d / peak : d;
+}
+
+struct Context {
+    const bench::Options& opt;
+    std::vector<bench::Result>& results;
+    const std::vector<float>& sig;
+    const std::vector<fixed_t>& sig_fixed;
+    int frames;
+    double slot_fixed_s;
+    double slot_float_s;
+};
+
+template <int N>
+void run_fdn(Context& ctx) {
+    const std::string prefix = "fdn" + std::to_string(N) + "/";
+    if (!ctx.opt.selected(prefix + "fixed") && !ctx.opt.selected(prefix + "float") && !ctx.opt.selected(prefix + "simd")) return;
+    std::vector<float> ref(ctx.frames), out(ctx.frames);
+
+    bench::Result fl = bench::measure(prefix + "float", "C++/3.cpp", "samples", ctx.opt.reps, [&]() {
+        fdn_frames<N, delay::F32>(ctx.sig, ref, ctx.frames);
+        return (long long)ctx.frames;
+    });
+    fl.extra.push_back({"speedup_vs_slot_loop", ctx.slot_float_s / fl.best_s});
+
+    bench::Result fx = bench::measure(prefix + "fixed", "C++/3.cpp", "samples", ctx.opt.reps, [&]() {
+        fdn_frames<N, delay::Raw<fixed_t>>(ctx.sig_fixed, out, ctx.frames);
+        return (long long)ctx.frames;
+    });
+    fx.extra.push_back({"speedup_vs_slot_loop", ctx.slot_fixed_s / fx.best_s});
+    fx.extra.push_back({"max_rel_diff_vs_float", max_rel_diff(out, ref)});
+
+    bench::Result sm = bench::measure(prefix + "simd", "C++/3.cpp", "samples", ctx.opt.reps, [&]() {
+        fdn_blocks<N>(ctx.sig, out, ctx.frames);
+        return (long long)ctx.frames;
+    });
+    sm.extra.push_back({"speedup_vs_slot_loop", ctx.slot_float_s / sm.best_s});
+    sm.extra.push_back({"max_rel_diff_vs_float", max_rel_diff(out, ref)});
+
+    for (bench::Result* r : {&fx, &fl, &sm}) {
+        if (ctx.opt.selected(r->name)) ctx.results.push_back(*r);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    const int frames = (int)opt.scaled(kSampleRate);
+    std::vector<float> sig;
+    make_signals(sig, frames);
+    std::vector<fixed_t> sig_fixed(sig.begin(), sig.end());
+    std::vector<float> out(frames);
+    std::vector<bench::Result> results;
+
+    bench::Result slot_fixed = bench::measure("slot_loop/fixed", "C++/3.cpp", "samples", opt.reps, [&]() {
+        slot_loop(sig_fixed, out, frames);
+        return (long long)frames;
+    });
+    bench::Result slot_float = bench::measure("slot_loop/float", "C++/3.cpp", "samples", opt.reps, [&]() {
+        slot_loop(sig, out, frames);
+        return (long long)frames;
+    });
+    if (opt.selected(slot_fixed.name)) results.push_back(slot_fixed);
+    if (opt.selected(slot_float.name)) results.push_back(slot_float);
+
+    Context ctx = {opt, results, sig, sig_fixed, frames, slot_fixed.best_s, slot_float.best_s};
+    run_fdn<4>(ctx);
+    run_fdn<8>(ctx);
+
+    return bench::report(opt, results);
+}
@@ -0,0 +1,44 @@
+// Throughput benchmark for the HLS kernels in C++/, run on the host through the
+// emulated HLS headers in C++/hls_emu. Reports samples/s (audio kernels) or
+// pixels/s (shader kernels) and ns per output, as a table and optionally JSON.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/kernel_bench.cpp C++/bench/kernels/*.cpp -pthread -o kernel_bench
+//
+// Run:
+//   ./kernel_bench [--reps N] [--scale F] [--filter NAME] [--json results.json]
+//
+// Extras: the FmSynthN::process rows report max_diff, their block output
+// against one frame per process() call (the top functions' synthesized path).
+//
+// Not covered: C++/9.cpp is an OpenCL host program with its own main().
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_case.h"
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    std::vector<bench::KernelCase> cases = bench::kernel_registry();
+    std::sort(cases.begin(), cases.end(), [](const bench::KernelCase& a, const bench::KernelCase& b) {
+        // Order by kernel number: "C++/2.cpp" before "C++/11.cpp".
+        if (a.source.size() != b.source.size()) return a.source.size() < b.source.size();
+        return a.source != b.source ? a.source < b.source : a.name < b.name;
+    });
+
+    std::vector<bench::Result> results;
+    for (const bench::KernelCase& c : cases) {
+        if (!opt.selected(c.name)) continue;
+        const long long n = opt.scaled(c.outputs);
+        std::fprintf(stderr, "running %s (%s)...\n", c.name.c_str(), c.source.c_str());
+        bench::Result r = bench::measure(c.name, c.source, c.unit, opt.reps, [&]() { return c.run(n); });
+        if (c.check) r.extra = c.check(n);
+        results.push_back(r);
+    }
+    return bench::report(opt, results);
+}
@@ -0,0 +1,45 @@
+// Benchmark driver for audio_synth (C++/1.cpp): 32-voice linear sine sweep.
+
+#include "kernel_case.h"
+
+namespace k1 {
+#include "../../1.cpp"
+}
+
+namespace {
+
+std::vector<float> starts, ends, output;
+
+void init_sweep(long long n) {
+    if (starts.empty()) {
+        for (int osc = 0; osc < NUM_OSC; ++osc) {
+            starts.push_back(20.0f + 61.0f * osc);
+            ends.push_back(2000.0f - 53.0f * osc);
+        }
+    }
+    output.resize(n);
+}
+
+long long run_audio_synth(long long n) {
+    init_sweep(n);
+    k1::audio_synth(starts.data(), ends.data(), output.data(), (int)n, 44100.0f);
+    return n;
+}
+
+long long run_audio_synth_simd(long long n) {
+    init_sweep(n);
+    k1::audio_synth_simd(starts.data(), ends.data(), output.data(), (int)n, 44100.0f);
+    return n;
+}
+
+long long run_audio_synth_parallel(long long n) {
+    init_sweep(n);
+    k1::audio_synth_parallel(starts.data(), ends.data(), output.data(), 0, n, 44100.0f, 0);
+    return n;
+}
+
+bench::RegisterKernel reg({"audio_synth", "C++/1.cpp", "samples", 4 * 44100, run_audio_synth});
+bench::RegisterKernel reg_simd({"audio_synth_simd", "C++/1.cpp", "samples", 4 * 44100, run_audio_synth_simd});
+bench::RegisterKernel reg_parallel({"audio_synth_parallel", "C++/1.cpp", "samples", 4 * 44100, run_audio_synth_parallel});
+
+} // namespace
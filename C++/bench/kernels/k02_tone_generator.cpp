@@ -0,0 +1,26 @@
+// Benchmark driver for tone_generator (C++/2.cpp): 32 LFO-modulated sines on ap_fixed<16,4>.
+
+#include "kernel_case.h"
+
+namespace k2 {
+#include "../../2.cpp"
+}
+
+namespace {
+
+long long run_tone_generator(long long n) {
+    static bool initialized = false;
+    if (!initialized) {
+        k2::init_frequencies();
+        initialized = true;
+    }
+    k2::fixed_t sample;
+    for (long long i = 0; i < n; ++i) {
+        k2::tone_generator(sample);
+    }
+    return n;
+}
+
+bench::RegisterKernel reg({"tone_generator", "C++/2.cpp", "samples", 20000, run_tone_generator});
+
+} // namespace
@@ -0,0 +1,22 @@
+// Benchmark driver for synth (C++/3.cpp): 16-voice percussion with shared reverb.
+
+#include "kernel_case.h"
+
+namespace k3 {
+#include "../../3.cpp"
+}
+
+namespace {
+
+long long run_perc_synth(long long n) {
+    hls::stream<ap_fixed<16,4>> out;
+    for (long long i = 0; i < n; ++i) {
+        k3::synth(out);
+        out.read();
+    }
+    return n;
+}
+
+bench::RegisterKernel reg({"synth (percussion)", "C++/3.cpp", "samples", 20000, run_perc_synth});
+
+} // namespace
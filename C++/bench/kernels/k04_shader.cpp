@@ -0,0 +1,40 @@
+// Benchmark driver for shader (C++/4.cpp): raymarched tunnel on ap_fixed<16,8>.
+
+#include "kernel_case.h"
+
+namespace k4 {
+#include "../../4.cpp"
+}
+
+namespace {
+
+// Renders whole frames at 16:9; n is rounded to a multiple of the frame size.
+long long run_shader(long long n) {
+    const int width = 32;
+    const int height = 18;
+    const long long frames = std::max(1LL, n / (width * height));
+    hls::stream<k4::vec3f> out;
+    for (long long f = 0; f < frames; ++f) {
+        k4::shader(out, k4::float_t(0.5f + f * 0.04f), width, height);
+        out.clear();
+    }
+    return frames * width * height;
+}
+
+// Same frames through the host tile renderer on every core
+long long run_shader_tiles(long long n) {
+    const int width = 32;
+    const int height = 18;
+    const long long frames = std::max(1LL, n / (width * height));
+    static host::ThreadPool pool;
+    std::vector<k4::vec3f> framebuffer(width * height);
+    for (long long f = 0; f < frames; ++f) {
+        k4::shader_tiles(framebuffer.data(), k4::float_t(0.5f + f * 0.04f), width, height, 8, pool, nullptr);
+    }
+    return frames * width * height;
+}
+
+bench::RegisterKernel reg({"shader", "C++/4.cpp", "pixels", 4 * 32 * 18, run_shader});
+bench::RegisterKernel reg_tiles({"shader_tiles", "C++/4.cpp", "pixels", 4 * 32 * 18, run_shader_tiles});
+
+} // namespace
@@ -0,0 +1,38 @@
+// Benchmark driver for synth (C++/5.cpp): granular FM with Dust-triggered grains.
+
+#include "kernel_case.h"
+
+namespace k5 {
+#include "../../5.cpp"
+}
+
+namespace {
+
+long long run_grain_synth(long long n) {
+    static std::vector<float> out;
+    out.resize(2 * n);
+    k5::synth(out.data(), (int)n);
+    return n;
+}
+
+// Same signal on the host SoA grain pool
+long long run_synth_grains(long long n) {
+    static std::vector<float> out;
+    out.resize(2 * n);
+    k5::synth_grains(out.data(), (int)n, 100.0f, 0.02f, nullptr);
+    return n;
+}
+
+// Same signal from the grain template cache (1e-3 per grain sample)
+long long run_synth_cached(long long n) {
+    static std::vector<float> out;
+    out.resize(2 * n);
+    k5::synth_cached(out.data(), (int)n, 100.0f, 0.02f, 1e-3f, nullptr);
+    return n;
+}
+
+bench::RegisterKernel reg({"synth (granular)", "C++/5.cpp", "samples", 4 * 44100, run_grain_synth});
+bench::RegisterKernel reg_grains({"synth_grains", "C++/5.cpp", "samples", 4 * 44100, run_synth_grains});
+bench::RegisterKernel reg_cached({"synth_cached", "C++/5.cpp", "samples", 4 * 44100, run_synth_cached});
+
+} // namespace
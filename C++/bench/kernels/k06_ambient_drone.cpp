@@ -0,0 +1,19 @@
+// Benchmark driver for ambient_drone (C++/6.cpp): detuned saws through comb reverbs.
+
+#include "kernel_case.h"
+
+namespace k6 {
+#include "../../6.cpp"
+}
+
+namespace {
+
+long long run_ambient_drone(long long n) {
+    hls::stream<float> left, right;
+    k6::ambient_drone(left, right, (int)n);
+    return (long long)left.size();
+}
+
+bench::RegisterKernel reg({"ambient_drone", "C++/6.cpp", "samples", 441000, run_ambient_drone});
+
+} // namespace
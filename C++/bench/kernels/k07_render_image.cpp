@@ -0,0 +1,38 @@
+// Benchmark driver for render_image (C++/7.cpp): refractive icosahedron on ap_fixed<32,16>.
+
+#include "kernel_case.h"
+
+namespace k7 {
+#include "../../7.cpp"
+}
+
+namespace {
+
+long long run_render_image(long long n) {
+    const int width = 32;
+    const int height = 24;
+    const long long frames = std::max(1LL, n / (width * height));
+    hls::stream<k7::vec4> out;
+    for (long long f = 0; f < frames; ++f) {
+        k7::render_image(out, k7::vec2(width, height), k7::float_t(1.0f + f * 0.04f));
+        out.clear();
+    }
+    return frames * width * height;
+}
+
+long long run_render_image_packets(long long n) {
+    const int width = 32;
+    const int height = 24;
+    const long long frames = std::max(1LL, n / (width * height));
+    std::vector<k7::vec4> framebuffer(width * height);
+    for (long long f = 0; f < frames; ++f) {
+        k7::render_image_packets(framebuffer.data(), k7::vec2(width, height), k7::float_t(1.0f + f * 0.04f),
+                                 k7::vec4(0, 0, 0, 0), nullptr);
+    }
+    return frames * width * height;
+}
+
+bench::RegisterKernel reg({"render_image", "C++/7.cpp", "pixels", 4 * 32 * 24, run_render_image});
+bench::RegisterKernel reg_packets({"render_image_packets", "C++/7.cpp", "pixels", 4 * 32 * 24, run_render_image_packets});
+
+} // namespace
@@ -0,0 +1,27 @@
+// Benchmark driver for hyperspatial_construct (C++/8.cpp): grid/node/beam overlay on ap_fixed<16,8>.
+
+#include "kernel_case.h"
+
+namespace k8 {
+#include "../../8.cpp"
+}
+
+namespace {
+
+long long run_hyperspatial(long long n) {
+    const int width = 64;
+    const int height = 36;
+    const long long frames = std::max(1LL, n / (width * height));
+    hls::stream<ap_axiu<24,1,1,1>> src, dst;
+    ap_axiu<24,1,1,1> pixel;
+    for (long long f = 0; f < frames; ++f) {
+        for (int i = 0; i < width * height; ++i) src.write(pixel);
+        k8::hyperspatial_construct(src, dst, k8::fixed_t(1.0f + f * 0.04f), width, height);
+        dst.clear();
+    }
+    return frames * width * height;
+}
+
+bench::RegisterKernel reg({"hyperspatial_construct", "C++/8.cpp", "pixels", 4 * 64 * 36, run_hyperspatial});
+
+} // namespace
@@ -0,0 +1,23 @@
+// Benchmark driver for fm_synth_top (C++/10.cpp): 8 LFO-bent sines, float stream out.
+
+#include "kernel_case.h"
+
+namespace k10 {
+#include "../../10.cpp"
+}
+
+namespace {
+
+long long run_fm_synth_top(long long n) {
+    hls::stream<float> in, left, right;
+    for (long long i = 0; i < n; ++i) {
+        k10::fm_synth_top(in, left, right);
+        left.clear();
+        right.clear();
+    }
+    return n;
+}
+
+bench::RegisterKernel reg({"fm_synth_top", "C++/10.cpp", "samples", 441000, run_fm_synth_top});
+
+} // namespace
@@ -0,0 +1,23 @@
+// Benchmark driver for audio_synth (C++/11.cpp): 8 sines with AM, 24-bit stream out.
+
+#include "kernel_case.h"
+
+namespace k11 {
+#include "../../11.cpp"
+}
+
+namespace {
+
+long long run_wavetable_synth(long long n) {
+    hls::stream<ap_int<24>> left, right;
+    for (long long i = 0; i < n; ++i) {
+        k11::audio_synth(left, right, 1);
+        left.clear();
+        right.clear();
+    }
+    return n;
+}
+
+bench::RegisterKernel reg({"audio_synth (wavetable)", "C++/11.cpp", "samples", 441000, run_wavetable_synth});
+
+} // namespace
@@ -0,0 +1,70 @@
+// Benchmark driver for fm_synth1/2/3 (C++/12.cpp): FM drones through RLPF, tanh and FreeVerb.
+
+#include "kernel_case.h"
+
+namespace k12 {
+#include "../../12.cpp"
+}
+
+namespace {
+
+template<void (*Synth)(hls::stream<float>&, hls::stream<float>&)>
+long long run_fm_synth(long long n) {
+    hls::stream<float> left, right;
+    for (long long i = 0; i < n; ++i) {
+        Synth(left, right);
+        left.read();
+        right.read();
+    }
+    return n;
+}
+
+// Block API: one instance rendering n frames in blocks of BlockSize.
+template<typename Synth, int BlockSize>
+long long run_fm_block(long long n) {
+    static Synth synth;
+    static std::vector<float> left(BlockSize), right(BlockSize);
+    for (long long done = 0; done < n; done += BlockSize) {
+        synth.process(left.data(), right.data(), (int)std::min<long long>(BlockSize, n - done));
+    }
+    return n;
+}
+
+// max_diff: the block output against fresh instances fed one frame per
+// process() call, as the top functions run under synthesis (on the host they
+// buffer FM_TOP_BLOCK frames). Both instances use their own noise.
+template<typename Synth, int BlockSize>
+std::vector<std::pair<std::string, double>> check_fm_block(long long n) {
+    Synth block, frame;
+    std::vector<float> left(BlockSize), right(BlockSize);
+    double max_diff = 0.0;
+    for (long long done = 0; done < n; done += BlockSize) {
+        const int len = (int)std::min<long long>(BlockSize, n - done);
+        block.process(left.data(), right.data(), len);
+        for (int i = 0; i < len; ++i) {
+            float l, r;
+            frame.process(&l, &r, 1);
+            max_diff = std::max({max_diff, std::fabs((double)l - left[i]), std::fabs((double)r - right[i])});
+        }
+    }
+    return {{"max_diff", max_diff}};
+}
+
+bench::RegisterKernel reg1({"fm_synth1", "C++/12.cpp", "samples", 441000, run_fm_synth<k12::fm_synth1>});
+bench::RegisterKernel reg2({"fm_synth2", "C++/12.cpp", "samples", 441000, run_fm_synth<k12::fm_synth2>});
+bench::RegisterKernel reg3({"fm_synth3", "C++/12.cpp", "samples", 441000, run_fm_synth<k12::fm_synth3>});
+
+bench::RegisterKernel reg1b64({"FmSynth1::process/64", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth1, 64>,
+    check_fm_block<k12::FmSynth1, 64>});
+bench::RegisterKernel reg1b1024({"FmSynth1::process/1024", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth1, 1024>,
+    check_fm_block<k12::FmSynth1, 1024>});
+bench::RegisterKernel reg2b64({"FmSynth2::process/64", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth2, 64>,
+    check_fm_block<k12::FmSynth2, 64>});
+bench::RegisterKernel reg2b1024({"FmSynth2::process/1024", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth2, 1024>,
+    check_fm_block<k12::FmSynth2, 1024>});
+bench::RegisterKernel reg3b64({"FmSynth3::process/64", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth3, 64>,
+    check_fm_block<k12::FmSynth3, 64>});
+bench::RegisterKernel reg3b1024({"FmSynth3::process/1024", "C++/12.cpp", "samples", 441000, run_fm_block<k12::FmSynth3, 1024>,
+    check_fm_block<k12::FmSynth3, 1024>});
+
+} // namespace
@@ -0,0 +1,40 @@
+// Registration glue for the per-kernel benchmark drivers.
+// Each driver wraps one kernel source in its own namespace (the kernels reuse
+// names like vec3, NUM_OSC and synth) and registers one case per top function.
+
+#ifndef BENCH_KERNEL_CASE_H
+#define BENCH_KERNEL_CASE_H
+
+#include "kernel_includes.h"
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../bench.h"
+
+namespace bench {
+
+struct KernelCase {
+    std::string name;      // Top function name
+    std::string source;    // Kernel file, relative to the repository root
+    std::string unit;      // "samples" or "pixels"
+    long long outputs;     // Default workload per repetition
+    std::function<long long(long long)> run;  // Produces ~n outputs, returns the exact count
+    // Optional: accuracy extras for the row, computed once over n outputs
+    std::function<std::vector<std::pair<std::string, double>>(long long)> check;
+};
+
+inline std::vector<KernelCase>& kernel_registry() {
+    static std::vector<KernelCase> cases;
+    return cases;
+}
+
+struct RegisterKernel {
+    explicit RegisterKernel(KernelCase c) { kernel_registry().push_back(std::move(c)); }
+};
+
+} // namespace bench
+
+#endif // BENCH_KERNEL_CASE_H
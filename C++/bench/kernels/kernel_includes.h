@@ -0,0 +1,35 @@
+// Everything the kernel sources #include, pulled in ahead of the namespace that
+// wraps them so the include guards keep these headers at global scope.
+
+#ifndef BENCH_KERNEL_INCLUDES_H
+#define BENCH_KERNEL_INCLUDES_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <math.h>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <ap_fixed.h>
+#include <ap_int.h>
+#include <hls_math.h>
+#include <hls_stream.h>
+#include <hls_video.h>
+
+#include "../../dsp/blep.h"
+#include "../../dsp/delay.h"
+#include "../../dsp/envelope.h"
+#include "../../dsp/fdn.h"
+#include "../../dsp/numeric.h"
+#include "../../dsp/simd.h"
+#include "../../dsp/simd_math.h"
+#include "../../dsp/sine.h"
+#include "../../host/thread_pool.h"
+
+#endif // BENCH_KERNEL_INCLUDES_H
@@ -0,0 +1,148 @@
+// Voices sustained per core by the voice-parallel mixer (host/voice_mixer.h)
+// layering the synths: FmSynth1/2/3 instances from C++/12.cpp dealt in turn,
+// plus the single ambient_drone (C++/6.cpp) and synth (C++/3.cpp) instances
+// (both keep their state in statics, so there is one of each).
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/mixer_bench.cpp -pthread -o mixer_bench
+//
+// Cases (1 s of audio per rep, --scale multiplies it; rendered as fast as
+// possible, not on the audio clock):
+//   mixer/tK/bN   kVoices voices on K workers (K = 1..--threads, default all
+//                 cores), N = 64 or 256 frames per block
+// Extras: block render time p50/p99 against the block's duration (us), the
+// voices that fit in a block at the p99 time (voice cost taken as linear),
+// that per worker, and the speedup over one worker.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+#include "../host/voice_mixer.h"
+
+namespace k3 {
+#include "../3.cpp"
+}
+
+namespace k6 {
+#include "../6.cpp"
+}
+
+// 6.cpp and 12.cpp both define these
+#undef SAMPLE_RATE
+#undef PI
+
+namespace k12 {
+#include "../12.cpp"
+}
+
+namespace {
+
+const int kBlockSizes[] = {64, 256};
+const int kMaxBlock = 256;
+const int kFmVoices = 48;
+const int kVoices = kFmVoices + 2;
+const double kSampleRate = 44100.0;
+
+// Renders a block-API synth into its own scratch and adds it to the mix
+template <typename Synth>
+host::VoiceMixer::VoiceFn fm_voice() {
+    struct Voice {
+        Synth synth;
+        float l[kMaxBlock], r[kMaxBlock];
+    };
+    std::shared_ptr<Voice> v = std::make_shared<Voice>();
+    return [v](float* left, float* right, int n) {
+        v->synth.process(v->l, v->r, n);
+        for (int i = 0; i < n; ++i) {
+            left[i] += v->l[i];
+            right[i] += v->r[i];
+        }
+    };
+}
+
+void ambient_drone_voice(float* left, float* right, int n) {
+    hls::stream<float> out_l, out_r;
+    k6::ambient_drone(out_l, out_r, n);
+    for (int i = 0; i < n; ++i) {
+        left[i] += out_l.read();
+        right[i] += out_r.read();
+    }
+}
+
+void perc_synth_voice(float* left, float* right, int n) {
+    hls::stream<ap_fixed<16,4>> out;
+    for (int i = 0; i < n; ++i) {
+        k3::synth(out);
+        const float s = out.read().to_float();
+        left[i] += s;
+        right[i] += s;
+    }
+}
+
+void add_voices(host::VoiceMixer& mixer) {
+    for (int v = 0; v < kFmVoices; ++v) {
+        if (v % 3 == 0) mixer.add_voice(fm_voice<k12::FmSynth1>());
+        else if (v % 3 == 1) mixer.add_voice(fm_voice<k12::FmSynth2>());
+        else mixer.add_voice(fm_voice<k12::FmSynth3>());
+    }
+    mixer.add_voice(ambient_drone_voice);
+    mixer.add_voice(perc_synth_voice);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    const long long frames = opt.scaled((long long)kSampleRate);
+    const int max_threads = opt.thread_count();
+    std::vector<bench::Result> results;
+
+    for (int block : kBlockSizes) {
+        const double budget_us = 1e6 * block / kSampleRate;
+        double t1_s = 0.0;
+        for (int threads = 1; threads <= max_threads; ++threads) {
+            const std::string name = "mixer/t" + std::to_string(threads) + "/b" + std::to_string(block);
+            if (threads > 1 && !opt.selected(name)) continue;
+
+            host::VoiceMixer mixer(threads, kMaxBlock);
+            add_voices(mixer);
+            std::vector<float> left(block), right(block);
+            std::vector<double> block_us;
+            bench::Result r = bench::measure(name, "host/voice_mixer.h", "frames", opt.reps, [&]() {
+                block_us.clear();
+                for (long long done = 0; done < frames; done += block) {
+                    const int n = (int)std::min<long long>(block, frames - done);
+                    const auto t0 = std::chrono::steady_clock::now();
+                    mixer.render(left.data(), right.data(), n);
+                    block_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+                }
+                return frames;
+            });
+            if (threads == 1) t1_s = r.best_s;
+            if (!opt.selected(name)) continue;
+
+            std::sort(block_us.begin(), block_us.end());
+            const double p50 = block_us[block_us.size() / 2];
+            const double p99 = block_us[std::min(block_us.size() - 1, block_us.size() * 99 / 100)];
+            const double sustained = kVoices * budget_us / p99;
+            r.extra.push_back({"voices", (double)kVoices});
+            r.extra.push_back({"block_p50_us", p50});
+            r.extra.push_back({"block_p99_us", p99});
+            r.extra.push_back({"block_budget_us", budget_us});
+            r.extra.push_back({"voices_sustained", sustained});
+            r.extra.push_back({"voices_per_core", sustained / threads});
+            r.extra.push_back({"speedup_vs_t1", t1_s / r.best_s});
+            results.push_back(r);
+        }
+    }
+
+    return bench::report(opt, results);
+}
@@ -0,0 +1,195 @@
+// Scalar vs SIMD oscillator bank for the 32-voice sweep in C++/1.cpp, plus an
+// accuracy report of the vector polynomial sine against sinf.
+//
+// Build (from the repository root; -march=native picks AVX-512/AVX2 if present):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/osc_bank_bench.cpp -pthread -o osc_bank_bench
+//
+// Cases:
+//   audio_synth           the kernel as written (SINE_POLICY on a wrapped turn phase,
+//                         increment recomputed from the ramp every sample)
+//   bank_sinf_reference   wrapped turn phase + sinf, scalar (isolates the sine error)
+//   audio_synth_simd      SIMD bank with the polynomial sine
+//   audio_synth_seek      closed-form (seekable) phase, one thread
+//   audio_synth_parallel  time-sliced export of the seekable render on all cores
+//                         (--threads N to pick the worker count)
+// Long renders (--scale 6 = 60 s, --scale 360 = one hour) show the drift of
+// the accumulating paths against the closed-form reference.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace k1 {
+#include "../1.cpp"
+}
+
+namespace {
+
+const float kSampleRate = 44100.0f;
+
+// Scalar reference with the same phase scheme as audio_synth_simd but sinf,
+// so the difference between the two is the sine approximation alone.
+void bank_sinf_reference(const float* starts, const float* ends, float* output, int num_samples, float sample_rate) {
+    float inc0[NUM_OSC], dinc[NUM_OSC], phase[NUM_OSC];
+    for (int osc = 0; osc < NUM_OSC; ++osc) {
+        double sr = sample_rate;
+        inc0[osc] = (float)(starts[osc] / sr);
+        dinc[osc] = (float)((ends[osc] - starts[osc]) / (60.0 * sr * sr));
+        phase[osc] = 0.0f;
+    }
+    for (int i = 0; i < num_samples; ++i) {
+        float mix = 0.0f;
+        for (int osc = 0; osc < NUM_OSC; ++osc) {
+            phase[osc] += dinc[osc] * (float)i + inc0[osc];
+            phase[osc] -= std::floor(phase[osc]);
+            mix += sinf(2.0f * PI * phase[osc]) * 0.06f;
+        }
+        output[i] = mix;
+    }
+}
+
+// Mix at sample i in double precision from the closed-form phase, sampled
+// sparsely as the ground truth for long renders.
+double sweep_reference(const std::vector<float>& starts, const std::vector<float>& ends, uint64_t i, double sr) {
+    const uint64_t tri = (i & 1) ? (i + 1) / 2 * i : i / 2 * (i + 1);  // i * (i + 1) / 2
+    double mix = 0.0;
+    for (int osc = 0; osc < NUM_OSC; ++osc) {
+        double inc0 = starts[osc] / sr;
+        double dinc = (ends[osc] - starts[osc]) / (60.0 * sr * sr);
+        double ph = k1::sweep_frac_mul64(i + 1, inc0) + k1::sweep_frac_mul64(tri, dinc);
+        mix += std::sin(2.0 * M_PI * ph) * 0.06;
+    }
+    return mix;
+}
+
+double max_err_vs_reference(const std::vector<float>& starts, const std::vector<float>& ends,
+                            const std::vector<float>& out) {
+    const size_t stride = std::max<size_t>(1, out.size() / 4096);
+    double m = 0.0;
+    for (size_t i = 0; i < out.size(); i += stride) {
+        m = std::max(m, std::fabs(out[i] - sweep_reference(starts, ends, i, kSampleRate)));
+    }
+    return m;
+}
+
+double max_abs_diff(const std::vector<float>& a, const std::vector<float>& b) {
+    double m = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) m = std::max(m, (double)std::fabs(a[i] - b[i]));
+    return m;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+    const int threads = opt.thread_count();
+
+    std::vector<float> starts, ends;
+    for (int osc = 0; osc < NUM_OSC; ++osc) {
+        starts.push_back(20.0f + 61.0f * osc);
+        ends.push_back(2000.0f - 53.0f * osc);
+    }
+    const int n = (int)opt.scaled(10 * 44100);
+    std::vector<float> out_kernel(n), out_ref(n), out_simd(n), out_seek(n);
+
+    std::vector<bench::Result> results;
+    if (opt.selected("audio_synth")) {
+        results.push_back(bench::measure("audio_synth", "C++/1.cpp", "samples", opt.reps, [&]() {
+            k1::audio_synth(starts.data(), ends.data(), out_kernel.data(), n, kSampleRate);
+            return (long long)n;
+        }));
+    }
+    if (opt.selected("bank_sinf_reference")) {
+        results.push_back(bench::measure("bank_sinf_reference", "bench", "samples", opt.reps, [&]() {
+            bank_sinf_reference(starts.data(), ends.data(), out_ref.data(), n, kSampleRate);
+            return (long long)n;
+        }));
+    }
+    if (opt.selected("audio_synth_simd")) {
+        bench::Result r = bench::measure("audio_synth_simd", "C++/1.cpp", "samples", opt.reps, [&]() {
+            k1::audio_synth_simd(starts.data(), ends.data(), out_simd.data(), n, kSampleRate);
+            return (long long)n;
+        });
+        r.extra.push_back({"simd_width", (double)simd::kWidth});
+
+        // End-to-end accuracy: against the sinf reference (sine error only) and
+        // against the kernel as written (includes its radian phase drift).
+        bank_sinf_reference(starts.data(), ends.data(), out_ref.data(), n, kSampleRate);
+        k1::audio_synth(starts.data(), ends.data(), out_kernel.data(), n, kSampleRate);
+        r.extra.push_back({"max_err_vs_sinf_bank", max_abs_diff(out_simd, out_ref)});
+        r.extra.push_back({"max_err_vs_audio_synth", max_abs_diff(out_simd, out_kernel)});
+        r.extra.push_back({"max_err_vs_closed_form", max_err_vs_reference(starts, ends, out_simd)});
+        results.push_back(r);
+    }
+    if (opt.selected("audio_synth_seek")) {
+        bench::Result r = bench::measure("audio_synth_seek", "C++/1.cpp", "samples", opt.reps, [&]() {
+            k1::audio_synth_seek(starts.data(), ends.data(), out_seek.data(), 0, n, kSampleRate);
+            return (long long)n;
+        });
+        r.extra.push_back({"max_err_vs_closed_form", max_err_vs_reference(starts, ends, out_seek)});
+
+        // Random ranges re-rendered on their own must match the full render exactly
+        std::mt19937 rng(1);
+        std::vector<float> slice;
+        double seek_mismatch = 0.0;
+        for (int k = 0; k < 64; ++k) {
+            int first = (int)(rng() % n);
+            int len = 1 + (int)(rng() % std::min(n - first, 10000));
+            slice.resize(len);
+            k1::audio_synth_seek(starts.data(), ends.data(), slice.data(), first, len, kSampleRate);
+            for (int i = 0; i < len; ++i) seek_mismatch = std::max(seek_mismatch, (double)std::fabs(slice[i] - out_seek[first + i]));
+        }
+        r.extra.push_back({"seek_mismatch", seek_mismatch});
+        results.push_back(r);
+    }
+    if (opt.selected("audio_synth_parallel")) {
+        std::vector<float> out_par(n);
+        bench::Result r = bench::measure("audio_synth_parallel", "C++/1.cpp", "samples", opt.reps, [&]() {
+            k1::audio_synth_parallel(starts.data(), ends.data(), out_par.data(), 0, n, kSampleRate, threads);
+            return (long long)n;
+        });
+        k1::audio_synth_seek(starts.data(), ends.data(), out_seek.data(), 0, n, kSampleRate);
+        r.extra.push_back({"threads", (double)threads});
+        r.extra.push_back({"max_diff_vs_seek", max_abs_diff(out_par, out_seek)});
+        results.push_back(r);
+    }
+
+    // Sine accuracy over one period at 2^20 points
+    if (opt.selected("sin_turns")) {
+        const int points = 1 << 20;
+        double max_err = 0.0, sum_sq = 0.0;
+        alignas(64) float x[simd::kWidth], y[simd::kWidth];
+        for (int i = 0; i < points; i += simd::kWidth) {
+            for (int l = 0; l < simd::kWidth; ++l) x[l] = (float)(i + l) / points;
+            simd::store(y, simd::sin_turns(simd::load(x)));
+            for (int l = 0; l < simd::kWidth; ++l) {
+                double e = std::fabs((double)y[l] - (double)sinf(2.0f * PI * x[l]));
+                max_err = std::max(max_err, e);
+                sum_sq += e * e;
+            }
+        }
+        bench::Result r = bench::measure("sin_turns", "dsp/simd_math.h", "evals", opt.reps, [&]() {
+            simd::vfloat acc = simd::zero();
+            simd::vfloat ph = simd::iota() * simd::set1(1.0f / points);
+            const simd::vfloat step = simd::set1((float)simd::kWidth / points);
+            for (int i = 0; i < points; i += simd::kWidth) {
+                acc += simd::sin_turns(ph);
+                ph += step;
+            }
+            volatile float sink = simd::hsum(acc);
+            (void)sink;
+            return (long long)points;
+        });
+        r.extra.push_back({"max_abs_err_vs_sinf", max_err});
+        r.extra.push_back({"rms_err_vs_sinf", std::sqrt(sum_sq / points)});
+        results.push_back(r);
+    }
+
+    return bench::report(opt, results);
+}
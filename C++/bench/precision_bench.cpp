@@ -0,0 +1,256 @@
+// Precision/throughput explorer for the templated synth kernels: audio_synth_t
+// (C++/1.cpp), tone_generator_t (C++/2.cpp) and synth_t (C++/3.cpp), each on a
+// sweep of sample/phase type pairs, with the SNR against the same kernel on
+// double/double next to samples/sec. Pick the narrowest pair that meets the
+// noise floor.
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/precision_bench.cpp -pthread -o precision_bench
+//
+// Cases: KERNEL/SAMPLE/PHASE over 0.5 s of output (--scale multiplies it),
+// with f32/f64 for float/double, fixW.I for ap_fixed<W,I>, ufixW.I for
+// ap_ufixed<W,I> and qW.I for num::Q in the same terms (num::Q15 is q16.1,
+// num::Q31 q32.1). f64/f64 is the reference.
+// The sweep includes the types of the top functions: f32/f32 for
+// audio_synth, fix16.4/ufix32.0 for tone_generator, fix16.4/ufix16.0 for synth.
+// ap_fixed is emulated in double (C++/hls_emu), so its rates count
+// operations rather than predict FPGA or fixed-point CPU cost; the Q formats
+// are plain integer arithmetic. All cases evaluate sine through SINE_POLICY
+// (dsp/sine.h) on the phase as 32 bits, except the f64 phases of the
+// reference (double precision hls::sin). Q15 and Q31 hold [-1, 1), but the
+// mixes of audio_synth and synth peak near 1.9 and 1.5 and wrap; q16.4 and
+// q32.4 give the Q formats ap_fixed<W,4>'s headroom.
+// synth_t's output is its FDN reverb alone, silent until the longest delay
+// line has come round, so its cases render that warm-up first and measure
+// the 0.5 s after it.
+// Extras: snr_db (output power over error power against f64/f64) and
+// enob, the equivalent bits (snr_db - 1.76) / 6.02. A case that matches the
+// reference exactly gets exact=1 instead, one whose reference is silent over
+// the window silent_ref=1, and one whose output is silent (the type cannot
+// hold the signal at all) silent_out=1; none of them has an SNR. wraps=1
+// marks a sample type whose full scale is below the reference's peak
+// (ref_peak): its output wraps, and the SNR measures the wrapping.
+// tone_generator_t and synth_t keep their state in statics, one set per
+// instantiation: the SNR is taken on each instantiation's first render, and
+// the timed reps continue from there.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace k1 {
+#include "../1.cpp"
+}
+#undef NUM_OSC
+#undef PI
+
+namespace k2 {
+#include "../2.cpp"
+}
+
+namespace k3 {
+#include "../3.cpp"
+}
+
+namespace {
+
+const float kSampleRate = 44100.0f;
+
+template <typename T> struct TypeName;
+template <> struct TypeName<float> { static std::string get() { return "f32"; } };
+template <> struct TypeName<double> { static std::string get() { return "f64"; } };
+template <typename Int, int Frac>
+struct TypeName<num::Q<Int, Frac>> {
+    static std::string get() { return "q" + std::to_string(8 * sizeof(Int)) + "." + std::to_string(8 * (int)sizeof(Int) - Frac); }
+};
+template <int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct TypeName<ap_fixed<W, I, Q, O, N>> {
+    static std::string get() { return "fix" + std::to_string(W) + "." + std::to_string(I); }
+};
+template <int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct TypeName<ap_ufixed<W, I, Q, O, N>> {
+    static std::string get() { return "ufix" + std::to_string(W) + "." + std::to_string(I); }
+};
+
+// Largest value a sample type holds
+template <typename T> struct FullScale {
+    static double get() { return HUGE_VAL; }
+};
+template <typename Int, int Frac>
+struct FullScale<num::Q<Int, Frac>> {
+    static double get() { return std::ldexp(1.0, 8 * (int)sizeof(Int) - 1 - Frac); }
+};
+template <int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct FullScale<ap_fixed<W, I, Q, O, N>> {
+    static double get() { return std::ldexp(1.0, I - 1); }
+};
+template <int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct FullScale<ap_ufixed<W, I, Q, O, N>> {
+    static double get() { return std::ldexp(1.0, I); }
+};
+
+typedef ap_fixed<32, 4> fix32_4;
+typedef ap_fixed<24, 4> fix24_4;
+typedef ap_fixed<18, 4> fix18_4;
+typedef ap_fixed<16, 4> fix16_4;
+typedef ap_fixed<16, 2> fix16_2;
+typedef ap_fixed<12, 4> fix12_4;
+typedef ap_ufixed<32, 0> ufix32_0;
+typedef ap_ufixed<24, 0> ufix24_0;
+typedef ap_ufixed<16, 0> ufix16_0;
+typedef num::Q<int32_t, 28> q32_4;
+typedef num::Q<int16_t, 12> q16_4;
+
+// Each kernel renders n samples of its output as double, the first
+// warmup() of which the SNR skips
+
+struct AudioSynth {
+    static const char* name() { return "audio_synth"; }
+    static const char* source() { return "C++/1.cpp"; }
+    static int warmup() { return 0; }
+
+    template <typename Sample, typename Phase>
+    static void render(std::vector<double>& out, int n) {
+        static std::vector<float> starts, ends;
+        if (starts.empty()) {
+            for (int osc = 0; osc < 32; ++osc) {
+                starts.push_back(20.0f + 61.0f * osc);
+                ends.push_back(2000.0f - 53.0f * osc);
+            }
+        }
+        std::vector<Sample> buf(n);
+        k1::audio_synth_t<Sample, Phase>(starts.data(), ends.data(), buf.data(), n, kSampleRate);
+        out.resize(n);
+        for (int i = 0; i < n; ++i) out[i] = (double)buf[i];
+    }
+};
+
+struct ToneGenerator {
+    static const char* name() { return "tone_generator"; }
+    static const char* source() { return "C++/2.cpp"; }
+    static int warmup() { return 0; }
+
+    template <typename Sample, typename Phase>
+    static void render(std::vector<double>& out, int n) {
+        out.resize(n);
+        Sample s;
+        for (int i = 0; i < n; ++i) {
+            k2::tone_generator_t<Sample, Phase>(s);
+            out[i] = (double)s;
+        }
+    }
+};
+
+struct PercSynth {
+    static const char* name() { return "synth"; }
+    static const char* source() { return "C++/3.cpp"; }
+    static int warmup() { return fdn::kDelays4[3]; }
+
+    template <typename Sample, typename Phase>
+    static void render(std::vector<double>& out, int n) {
+        out.resize(n);
+        hls::stream<Sample> stream;
+        for (int i = 0; i < n; ++i) {
+            k3::synth_t<Sample, Phase>(stream);
+            out[i] = (double)stream.read();
+        }
+    }
+};
+
+struct Error {
+    double sig = 0.0, err = 0.0, out = 0.0;  // Reference, error and output power
+};
+
+Error error_power(const std::vector<double>& out, const std::vector<double>& ref, int from) {
+    Error e;
+    for (size_t i = from; i < ref.size(); ++i) {
+        e.sig += ref[i] * ref[i];
+        e.err += (out[i] - ref[i]) * (out[i] - ref[i]);
+        e.out += out[i] * out[i];
+    }
+    return e;
+}
+
+struct Context {
+    const bench::Options& opt;
+    std::vector<bench::Result>& results;
+    int frames;               // Measured, after the kernel's warm-up
+    std::vector<double> ref;  // The kernel's first render on double/double
+};
+
+template <typename K, typename Sample, typename Phase>
+void run_case(Context& ctx) {
+    const std::string name = std::string(K::name()) + "/" + TypeName<Sample>::get() + "/" + TypeName<Phase>::get();
+    if (!ctx.opt.selected(name)) return;
+    const bool is_ref = std::is_same<Sample, double>::value && std::is_same<Phase, double>::value;
+    const int n = K::warmup() + ctx.frames;
+    std::vector<double> out;
+    if (!is_ref) K::template render<Sample, Phase>(out, n);
+    const Error e = is_ref ? Error() : error_power(out, ctx.ref, K::warmup());
+
+    bench::Result r = bench::measure(name, K::source(), "samples", ctx.opt.reps, [&]() {
+        K::template render<Sample, Phase>(out, n);
+        return (long long)n;
+    });
+    if (!is_ref) {
+        if (e.sig == 0.0) {
+            r.extra.push_back({"silent_ref", 1.0});
+        } else if (e.err == 0.0) {
+            r.extra.push_back({"exact", 1.0});
+        } else if (e.out == 0.0) {
+            r.extra.push_back({"silent_out", 1.0});
+        } else {
+            const double snr = 10.0 * std::log10(e.sig / e.err);
+            r.extra.push_back({"snr_db", snr});
+            r.extra.push_back({"enob", (snr - 1.76) / 6.02});
+        }
+        double peak = 0.0;
+        for (double x : ctx.ref) peak = std::max(peak, std::fabs(x));
+        if (peak >= FullScale<Sample>::get()) {
+            r.extra.push_back({"wraps", 1.0});
+            r.extra.push_back({"ref_peak", peak});
+        }
+    }
+    ctx.results.push_back(r);
+}
+
+template <typename K>
+void sweep(Context& ctx) {
+    K::template render<double, double>(ctx.ref, K::warmup() + ctx.frames);
+    run_case<K, double, double>(ctx);
+    run_case<K, float, float>(ctx);
+    run_case<K, num::Q31, num::Q31>(ctx);
+    run_case<K, num::Q15, num::Q31>(ctx);
+    run_case<K, num::Q15, num::Q15>(ctx);
+    run_case<K, q32_4, num::Q31>(ctx);
+    run_case<K, q16_4, num::Q31>(ctx);
+    run_case<K, fix32_4, ufix32_0>(ctx);
+    run_case<K, fix24_4, ufix24_0>(ctx);
+    run_case<K, fix18_4, ufix24_0>(ctx);
+    run_case<K, fix16_4, ufix32_0>(ctx);
+    run_case<K, fix16_4, ufix16_0>(ctx);
+    run_case<K, fix16_2, ufix16_0>(ctx);
+    run_case<K, fix12_4, ufix16_0>(ctx);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    k2::init_frequencies();
+    std::vector<bench::Result> results;
+    Context ctx = {opt, results, (int)opt.scaled(kSampleRate / 2), {}};
+    sweep<AudioSynth>(ctx);
+    sweep<ToneGenerator>(ctx);
+    sweep<PercSynth>(ctx);
+
+    return bench::report(opt, results);
+}
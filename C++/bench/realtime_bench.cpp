@@ -0,0 +1,188 @@
+// The audio kernels played in real time through host::RealtimeEngine
+// (host/realtime.h): a producer thread renders blocks into an SPSC ring and a
+// sink thread drains it once per device period at the nominal sample rate,
+// so the numbers are what an audio callback would see for each block size.
+//
+// Build (from the repository root):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/realtime_bench.cpp -pthread -o realtime_bench
+//
+// Cases (1 s of audio per case, --scale multiplies it; runs in wall time, so
+// --reps is ignored):
+//   fm_synth1/bN        FmSynth1::process (C++/12.cpp)
+//   fm_synth1_hall/bN   the same through host::ConvolutionReverb
+//                       (host/conv_reverb.h) on a 2 s hall IR
+//   ambient_drone/bN    ambient_drone (C++/6.cpp), N samples per call
+//   tone_generator/bN   tone_generator (C++/2.cpp), one call per sample, 48 kHz
+// with N = 64, 256, 1024 frames per block and per device period and a ring
+// of kRingBlocks blocks. Extras: render time percentiles per block (us),
+// render deadline misses, sink xruns and the silence they inserted, block
+// latency (render start to last frame played, ms) and CPU load.
+// Set REALTIME_WAV_DIR to also write what the sink played to
+// <dir>/<synth>_bN.wav, and REALTIME_IR to a 44.1 kHz WAV file to use that
+// IR for the hall instead of white noise decaying by 60 dB over 2 s.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+#include "../host/conv_reverb.h"
+#include "../host/realtime.h"
+
+namespace k2 {
+#include "../2.cpp"
+}
+
+namespace k6 {
+#include "../6.cpp"
+}
+
+// 6.cpp and 12.cpp both define these
+#undef SAMPLE_RATE
+#undef PI
+
+namespace k12 {
+#include "../12.cpp"
+}
+
+namespace {
+
+const int kBlockSizes[] = {64, 256, 1024};
+const int kRingBlocks = 4;
+
+struct Synth {
+    const char* name;
+    const char* source;
+    int sample_rate;
+    host::RealtimeEngine::RenderFn (*make)();
+};
+
+host::RealtimeEngine::RenderFn make_fm_synth1() {
+    std::shared_ptr<k12::FmSynth1> synth = std::make_shared<k12::FmSynth1>();
+    return [synth](float* left, float* right, int n) { synth->process(left, right, n); };
+}
+
+host::WavData hall_ir;
+
+host::RealtimeEngine::RenderFn make_fm_synth1_hall() {
+    std::shared_ptr<k12::FmSynth1> synth = std::make_shared<k12::FmSynth1>();
+    std::shared_ptr<host::ConvolutionReverb> hall = std::make_shared<host::ConvolutionReverb>(hall_ir, 0.5f, 0.7f);
+    return [synth, hall](float* left, float* right, int n) {
+        synth->process(left, right, n);
+        hall->process(left, right, n);
+    };
+}
+
+// ambient_drone keeps its state in statics, so it continues across cases
+host::RealtimeEngine::RenderFn make_ambient_drone() {
+    return [](float* left, float* right, int n) {
+        hls::stream<float> out_l, out_r;
+        k6::ambient_drone(out_l, out_r, n);
+        for (int i = 0; i < n; ++i) {
+            left[i] = out_l.read();
+            right[i] = out_r.read();
+        }
+    };
+}
+
+host::RealtimeEngine::RenderFn make_tone_generator() {
+    return [](float* left, float* right, int n) {
+        k2::fixed_t sample;
+        for (int i = 0; i < n; ++i) {
+            k2::tone_generator(sample);
+            left[i] = right[i] = sample.to_float();
+        }
+    };
+}
+
+const Synth kSynths[] = {
+    {"fm_synth1", "C++/12.cpp", 44100, make_fm_synth1},
+    {"fm_synth1_hall", "C++/12.cpp", 44100, make_fm_synth1_hall},
+    {"ambient_drone", "C++/6.cpp", 44100, make_ambient_drone},
+    {"tone_generator", "C++/2.cpp", 48000, make_tone_generator},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    k2::init_frequencies();
+    const char* wav_dir = std::getenv("REALTIME_WAV_DIR");
+    if (const char* ir_path = std::getenv("REALTIME_IR")) {
+        if (!host::read_wav(ir_path, hall_ir)) return 1;
+        if (hall_ir.sample_rate != 44100 || hall_ir.frames() == 0) {
+            std::fprintf(stderr, "%s: need a non-empty 44.1 kHz IR\n", ir_path);
+            return 1;
+        }
+    } else {
+        hall_ir.channels = 1;
+        hall_ir.sample_rate = 44100;
+        hall_ir.samples.resize(2 * 44100);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        for (size_t i = 0; i < hall_ir.samples.size(); ++i) {
+            hall_ir.samples[i] = u(rng) * (float)std::pow(10.0, -3.0 * i / hall_ir.samples.size()) * 0.05f;
+        }
+    }
+
+    std::vector<bench::Result> results;
+    for (const Synth& s : kSynths) {
+        for (int block : kBlockSizes) {
+            const std::string name = std::string(s.name) + "/b" + std::to_string(block);
+            if (!opt.selected(name)) continue;
+
+            host::RealtimeConfig config;
+            config.sample_rate = s.sample_rate;
+            config.block_frames = block;
+            config.period_frames = block;
+            config.buffer_frames = kRingBlocks * block;
+            config.seconds = opt.scale;
+
+            host::NullSink null_sink;
+            std::unique_ptr<host::WavFileSink> wav;
+            if (wav_dir) {
+                const std::string path = std::string(wav_dir) + "/" + s.name + "_b" + std::to_string(block) + ".wav";
+                wav.reset(new host::WavFileSink(path.c_str(), s.sample_rate));
+                if (!wav->ok()) {
+                    std::fprintf(stderr, "cannot write %s\n", path.c_str());
+                    return 1;
+                }
+            }
+
+            host::RealtimeEngine engine(config);
+            const auto t0 = std::chrono::steady_clock::now();
+            const host::RealtimeStats st = engine.run(s.make(), wav ? (host::AudioSink&)*wav : null_sink);
+            const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            bench::Result r;
+            r.name = name;
+            r.source = s.source;
+            r.unit = "frames";
+            r.outputs = st.frames_played;
+            r.reps = 1;
+            r.best_s = r.median_s = wall_s;
+            r.extra.push_back({"render_p50_us", st.render_p50_us});
+            r.extra.push_back({"render_p99_us", st.render_p99_us});
+            r.extra.push_back({"render_p999_us", st.render_p999_us});
+            r.extra.push_back({"render_max_us", st.render_max_us});
+            r.extra.push_back({"block_budget_us", 1e6 * block / s.sample_rate});
+            r.extra.push_back({"deadline_misses", (double)st.deadline_misses});
+            r.extra.push_back({"xruns", (double)st.xruns});
+            r.extra.push_back({"xrun_frames", (double)st.xrun_frames});
+            r.extra.push_back({"latency_mean_ms", st.latency_mean_ms});
+            r.extra.push_back({"latency_max_ms", st.latency_max_ms});
+            r.extra.push_back({"cpu_load", st.cpu_load});
+            results.push_back(r);
+        }
+    }
+
+    return bench::report(opt, results);
+}
@@ -0,0 +1,162 @@
+// Accuracy against cost for the sine policies of dsp/sine.h: every policy
+// drives a bank of oscillators on 32-bit phases, one sample at a time
+// (Osc::next, as the kernels do) and a block at a time (Osc::render, the
+// host's vector path).
+//
+// Build (from the repository root; -march=native picks AVX-512/AVX2 if present):
+//   g++ -O2 -march=native -std=c++17 -Wno-unknown-pragmas -I C++ C++/bench/sine_bench.cpp -o sine_bench
+//
+// Cases POLICY/scalar and POLICY/simd, 16 oscillators from 27.5 Hz to 5 kHz
+// rendered in 64-sample blocks for 1 s (--scale multiplies it; outputs are
+// samples):
+//   lutB        sine::Lut<B>, B = 8, 10, 12, 14 (ROM of 2^B + 1 floats)
+//   cordicN     sine::Cordic<N>, N = 12, 16, 20, 24 iterations
+//   minimaxD    sine::Minimax<D>, D = 5, 7, 9
+//   rotator     sine::Osc<sine::Rotator>
+// Baselines, scalar only:
+//   sinf        std::sin in float on the phase in radians (C++/1.cpp before)
+//   trunc_lut14 16384 points without interpolation (C++/12.cpp's sin_lut
+//               before)
+// Extras: max_abs_err against sin in double over the whole render, bits
+// (-log2 of it), and cycles_per_sample from the time stamp counter (x86
+// only: reference cycles at the nominal clock, not turbo).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SINE_BENCH_TSC 1
+#endif
+
+#include "bench.h"
+#include "dsp/sine.h"
+
+namespace {
+
+const double kSampleRate = 44100.0;
+const int kOscs = 16;
+const int kBlock = 64;
+
+struct Sinf {
+    static float sin(uint32_t phase) { return std::sin((float)phase * (float)(2.0 * M_PI / 4294967296.0)); }
+};
+
+struct TruncLut14 {
+    static float sin(uint32_t phase) {
+        static std::vector<float> table;
+        if (table.empty()) {
+            for (int i = 0; i < 16384; ++i) table.push_back((float)std::sin(2.0 * M_PI * i / 16384));
+        }
+        return table[phase >> 18];
+    }
+};
+
+// Time stamp counter ticks per second, 0 when there is none
+double tsc_hz() {
+#if SINE_BENCH_TSC
+    const double t0 = bench::now_seconds();
+    const unsigned long long c0 = __rdtsc();
+    while (bench::now_seconds() - t0 < 0.05) {
+    }
+    return (double)(__rdtsc() - c0) / (bench::now_seconds() - t0);
+#else
+    return 0.0;
+#endif
+}
+
+template <typename P>
+void make_bank(std::vector<sine::Osc<P>>& oscs) {
+    oscs.assign(kOscs, sine::Osc<P>());
+    for (int i = 0; i < kOscs; ++i) oscs[i].set_freq(27.5 * std::pow(2.0, 0.5 * i), kSampleRate);
+}
+
+// The scalar baselines have no vector sin(), so no render()
+template <typename P, bool V>
+void bank_block(std::vector<sine::Osc<P>>& oscs, std::vector<float>& out) {
+    for (int i = 0; i < kOscs; ++i) {
+        float* dst = &out[(size_t)i * kBlock];
+        if constexpr (V) {
+            oscs[i].render(dst, kBlock);
+        } else {
+            for (int s = 0; s < kBlock; ++s) dst[s] = oscs[i].next();
+        }
+    }
+}
+
+struct Context {
+    const bench::Options& opt;
+    std::vector<bench::Result>& results;
+    int blocks;
+    double tsc_hz;
+};
+
+template <typename P, bool V>
+void run_case(Context& ctx, const std::string& policy) {
+    const std::string name = policy + (V ? "/simd" : "/scalar");
+    if (!ctx.opt.selected(name)) return;
+    std::vector<sine::Osc<P>> oscs;
+    std::vector<float> out((size_t)kOscs * kBlock);
+
+    // Error over one render, against the exact phases
+    make_bank(oscs);
+    double err = 0.0;
+    for (int b = 0; b < ctx.blocks; ++b) {
+        std::vector<uint32_t> start(kOscs);
+        for (int i = 0; i < kOscs; ++i) start[i] = oscs[i].phase;
+        bank_block<P, V>(oscs, out);
+        for (int i = 0; i < kOscs; ++i) {
+            for (int s = 0; s < kBlock; ++s) {
+                const uint32_t phase = start[i] + (uint32_t)s * oscs[i].inc;
+                const double ref = std::sin(2.0 * M_PI * phase / 4294967296.0);
+                err = std::max(err, std::fabs(out[(size_t)i * kBlock + s] - ref));
+            }
+        }
+    }
+
+    make_bank(oscs);
+    bench::Result r = bench::measure(name, "C++/dsp/sine.h", "samples", ctx.opt.reps, [&]() {
+        for (int b = 0; b < ctx.blocks; ++b) bank_block<P, V>(oscs, out);
+        return (long long)ctx.blocks * kOscs * kBlock;
+    });
+    r.extra.push_back({"max_abs_err", err});
+    r.extra.push_back({"bits", -std::log2(err)});
+    if (ctx.tsc_hz > 0.0) r.extra.push_back({"cycles_per_sample", r.best_s / r.outputs * ctx.tsc_hz});
+    ctx.results.push_back(r);
+}
+
+template <typename P>
+void both(Context& ctx, const std::string& policy) {
+    run_case<P, false>(ctx, policy);
+    run_case<P, true>(ctx, policy);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    std::vector<bench::Result> results;
+    Context ctx = {opt, results, (int)(opt.scaled((long long)kSampleRate) / kBlock), tsc_hz()};
+    both<sine::Lut<8>>(ctx, "lut8");
+    both<sine::Lut<10>>(ctx, "lut10");
+    both<sine::Lut<12>>(ctx, "lut12");
+    both<sine::Lut<14>>(ctx, "lut14");
+    both<sine::Cordic<12>>(ctx, "cordic12");
+    both<sine::Cordic<16>>(ctx, "cordic16");
+    both<sine::Cordic<20>>(ctx, "cordic20");
+    both<sine::Cordic<24>>(ctx, "cordic24");
+    both<sine::Minimax<5>>(ctx, "minimax5");
+    both<sine::Minimax<7>>(ctx, "minimax7");
+    both<sine::Minimax<9>>(ctx, "minimax9");
+    both<sine::Rotator>(ctx, "rotator");
+    run_case<Sinf, false>(ctx, "sinf");
+    run_case<TruncLut14, false>(ctx, "trunc_lut14");
+
+    return bench::report(opt, results);
+}
@@ -0,0 +1,129 @@
+// Multi-threaded tile rendering of the tunnel shader in C++/4.cpp, scaled from
+// 1 to N worker threads on the work-stealing pool in C++/host/thread_pool.h.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Wno-unknown-pragmas -I C++/hls_emu C++/bench/tile_render_bench.cpp -pthread -o tile_render_bench
+//
+// Run:
+//   ./tile_render_bench [--threads N] [--scale F] [--reps N] [--json PATH]
+//
+// Cases:
+//   shader              the streaming HLS top function, one pixel at a time
+//   shader_tiles/tK     16x16 tiles on K threads, K = 1..N (N = --threads or all cores)
+// Extras per tile case: speedup and parallel efficiency against 1 thread,
+// tile cost distribution (min/median/max ms, max/mean imbalance), steals,
+// march steps per frame, and the max difference to the stream output. A map of
+// the per-tile cost at N threads is printed on stderr.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "kernels/kernel_includes.h"
+
+namespace k4 {
+#include "../4.cpp"
+}
+
+namespace {
+
+const int kTile = 16;
+const float kTime = 1.3f;
+
+long long count_steps(const std::vector<k4::TileTiming>& timings) {
+    long long steps = 0;
+    for (const k4::TileTiming& t : timings) steps += t.steps;
+    return steps;
+}
+
+double max_diff(const std::vector<k4::vec3f>& a, const std::vector<k4::vec3f>& b) {
+    double d = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        d = std::max({d, (double)std::fabs(a[i].x - b[i].x), (double)std::fabs(a[i].y - b[i].y),
+                      (double)std::fabs(a[i].z - b[i].z)});
+    }
+    return d;
+}
+
+void print_tile_map(const std::vector<k4::TileTiming>& timings, int tiles_x) {
+    double max_s = 0.0;
+    for (const k4::TileTiming& t : timings) max_s = std::max(max_s, t.seconds);
+    const char* shades = " .:-=+*#%@";
+    std::fprintf(stderr, "tile cost (%dx%d tiles, ' ' cheapest .. '@' = %.2f ms):\n", tiles_x,
+                 (int)timings.size() / tiles_x, max_s * 1e3);
+    for (size_t i = 0; i < timings.size(); ++i) {
+        int level = max_s > 0.0 ? (int)(9.0 * timings[i].seconds / max_s + 0.5) : 0;
+        std::fputc(shades[level], stderr);
+        if ((int)(i + 1) % tiles_x == 0) std::fputc('\n', stderr);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    if (!opt.parse(argc, argv)) return 1;
+
+    // Default 160x90; --scale multiplies the pixel count
+    const double s = std::sqrt(opt.scale);
+    const int width = std::max(kTile, (int)(160 * s));
+    const int height = std::max(kTile, (int)(90 * s));
+    const long long pixels = (long long)width * height;
+    const int max_threads = opt.thread_count();
+
+    std::vector<k4::vec3f> reference(pixels), framebuffer(pixels);
+    std::vector<bench::Result> results;
+
+    {
+        hls::stream<k4::vec3f> out;
+        bench::Result r = bench::measure("shader", "C++/4.cpp", "pixels", opt.reps, [&]() {
+            k4::shader(out, k4::float_t(kTime), width, height);
+            for (long long i = 0; i < pixels; ++i) reference[i] = out.read();
+            return pixels;
+        });
+        if (opt.selected("shader")) results.push_back(r);
+    }
+
+    double base_s = 0.0;
+    for (int threads = 1; threads <= max_threads; ++threads) {
+        const std::string name = "shader_tiles/t" + std::to_string(threads);
+        if (threads > 1 && !opt.selected(name)) continue;
+
+        host::ThreadPool pool(threads);
+        std::vector<k4::TileTiming> timings;
+        bench::Result r = bench::measure(name, "C++/4.cpp", "pixels", opt.reps, [&]() {
+            k4::shader_tiles(framebuffer.data(), k4::float_t(kTime), width, height, kTile, pool, &timings);
+            return pixels;
+        });
+        if (threads == 1) base_s = r.best_s;
+
+        std::vector<double> tile_s;
+        double sum_s = 0.0;
+        for (const k4::TileTiming& t : timings) {
+            tile_s.push_back(t.seconds);
+            sum_s += t.seconds;
+        }
+        std::sort(tile_s.begin(), tile_s.end());
+
+        const double speedup = base_s / r.best_s;
+        r.extra.push_back({"threads", (double)threads});
+        r.extra.push_back({"speedup", speedup});
+        r.extra.push_back({"efficiency", speedup / threads});
+        r.extra.push_back({"tiles", (double)tile_s.size()});
+        r.extra.push_back({"tile_ms_min", tile_s.front() * 1e3});
+        r.extra.push_back({"tile_ms_median", tile_s[tile_s.size() / 2] * 1e3});
+        r.extra.push_back({"tile_ms_max", tile_s.back() * 1e3});
+        r.extra.push_back({"tile_imbalance", tile_s.back() / (sum_s / tile_s.size())});
+        r.extra.push_back({"steals_per_frame", (double)pool.steals() / (opt.reps + 1)});
+        r.extra.push_back({"steps_per_frame", (double)count_steps(timings)});
+        r.extra.push_back({"max_diff_vs_shader", max_diff(framebuffer, reference)});
+        if (opt.selected(name)) results.push_back(r);
+
+        if (threads == max_threads) print_tile_map(timings, (width + kTile - 1) / kTile);
+    }
+
+    return bench::report(opt, results);
+}
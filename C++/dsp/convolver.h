@@ -0,0 +1,202 @@
+// Partitioned FFT convolution for long measured impulse responses (several
+// seconds), at a fixed block size and with zero added latency. Uses overlap-save:
+// each partition of the IR is transformed once, and every block of input is
+// transformed once into a frequency-domain delay line (FDL). One output block
+// is then the sum of the FDL spectra times the IR spectra, inverse transformed.
+// The partitions are non-uniform: stage 0 cuts the IR head into block-sized
+// partitions and runs its whole FFT pair on every call. Each later stage uses
+// partitions kGrowth times larger than the one before, and begins 2L samples
+// into the IR for its partition size L. That leaves it a full period of L
+// frames between an input window completing and its output falling due: the
+// forward FFT passes, the partition products and the inverse FFT passes of
+// one window are spread evenly over the process() calls of the next period,
+// so no single call carries a large transform. With max_partition equal to
+// block, the whole IR is one uniform stage.
+// All spectra, tables and buffers are allocated by the constructor, so
+// process() never allocates. Host only (dsp/simd.h and std::vector); not for HLS.
+
+#ifndef DSP_CONVOLVER_H
+#define DSP_CONVOLVER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "fft.h"
+#include "simd.h"
+
+namespace conv {
+
+class Convolver {
+public:
+    static const int kGrowth = 16;  // Partition size ratio between stages
+
+    // ir[0..len) mono; block and max_partition powers of two, block >= 4
+    Convolver(const float* ir, int len, int block = 64, int max_partition = 16384) : block_(block) {
+        // Stage k + 1 starts at twice its partition size, where stage k ends
+        int start = 0;
+        int size = block;
+        while (start < len) {
+            const bool last = size * kGrowth > max_partition;
+            const int end = last ? len : std::min(len, 2 * size * kGrowth);
+            stages_.emplace_back(ir, start, end, size, block);
+            start = end;
+            size *= kGrowth;
+        }
+    }
+
+    int block() const { return block_; }
+    int stages() const { return (int)stages_.size(); }
+    int partition_size(int stage) const { return stages_[stage].size; }
+    int partitions(int stage) const { return stages_[stage].parts; }
+
+    // Bytes of IR spectra, FDLs and buffers
+    std::size_t bytes() const {
+        std::size_t b = 0;
+        for (const Stage& s : stages_) b += s.bytes();
+        return b;
+    }
+
+    // One block of frames from in to out (may alias)
+    void process(const float* in, float* out) {
+        for (Stage& s : stages_) s.push(in, block_);
+        std::fill(out, out + block_, 0.0f);
+        for (Stage& s : stages_) s.run(out, block_);
+    }
+
+private:
+    struct Stage {
+        int size;      // Partition size L in frames; the FFT has 2L points
+        int offset;    // IR position of partition 0: 0 for stage 0, else 2L
+        int parts;     // Partitions
+        int stride;    // L + 1 bins, padded to simd::kWidth
+        int calls;     // process() calls per L frames
+        int phase;     // Call within the current L frames
+        int head;      // FDL slot of the newest input spectrum
+        int tasks;     // Spread work per period: FFT passes and partition products
+        int done;      // Tasks of the current period already run
+        int cur;       // Output buffer being emitted
+        fft::RealFft fft;
+        std::vector<float> ir;      // Partition spectra: re then im, stride apart
+        std::vector<float> fdl;     // Input spectra ring, same layout
+        std::vector<float> acc;     // Spectrum of the next output block
+        std::vector<float> window;  // Previous L input frames, then current L
+        std::vector<float> time[2]; // Inverse transforms, 2L frames: one emitted, one in progress
+
+        Stage(const float* h, int start, int end, int L, int block)
+            : size(L), offset(start), parts((end - start + L - 1) / L),
+              stride((L + 1 + simd::kWidth - 1) / simd::kWidth * simd::kWidth),
+              calls(L / block), phase(0), head(0), cur(0), fft(2 * L),
+              ir((std::size_t)parts * 2 * stride, 0.0f), fdl(ir.size(), 0.0f),
+              acc(2 * stride, 0.0f), window(2 * L, 0.0f) {
+            // Forward passes after the pack, products, inverse passes
+            tasks = fft.passes() - 1 + parts + fft.passes();
+            done = tasks;
+            time[0].assign(2 * L, 0.0f);
+            time[1].assign(2 * L, 0.0f);
+            // Zero-padded partitions, scaled by 1/2L for the unnormalized
+            // transform pair
+            const float scale = 1.0f / (2 * L);
+            std::vector<float>& x = time[0];
+            for (int p = 0; p < parts; p++) {
+                std::fill(x.begin(), x.end(), 0.0f);
+                for (int i = 0; i < L && start + p * L + i < end; i++) x[i] = h[start + p * L + i] * scale;
+                float* re = &ir[(std::size_t)p * 2 * stride];
+                fft.forward(x.data(), re, re + stride);
+            }
+            std::fill(x.begin(), x.end(), 0.0f);
+        }
+
+        std::size_t bytes() const {
+            return (ir.size() + fdl.size() + acc.size() + window.size() + time[0].size() + time[1].size()) *
+                   sizeof(float);
+        }
+
+        float* slot(std::vector<float>& v, int p) { return &v[(std::size_t)p * 2 * stride]; }
+
+        void push(const float* in, int block) {
+            std::copy(in, in + block, &window[size + phase * block]);
+        }
+
+        // acc += partition p's spectrum times the input spectrum p blocks
+        // back from the newest
+        void mac(int p) {
+            const int W = simd::kWidth;
+            int s = head - p;
+            if (s < 0) s += parts;
+            const float* xr = slot(fdl, s);
+            const float* xi = xr + stride;
+            const float* hr = slot(ir, p);
+            const float* hi = hr + stride;
+            float* ar = acc.data();
+            float* ai = ar + stride;
+            for (int k = 0; k < stride; k += W) {
+                const simd::vfloat a = simd::loadu(xr + k), b = simd::loadu(xi + k);
+                const simd::vfloat c = simd::loadu(hr + k), d = simd::loadu(hi + k);
+                simd::storeu(ar + k, simd::fmadd(a, c, simd::loadu(ar + k)) - b * d);
+                simd::storeu(ai + k, simd::fmadd(a, d, simd::fmadd(b, c, simd::loadu(ai + k))));
+            }
+        }
+
+        // Spread task t of the window in flight: forward passes 1.., the
+        // products, then the inverse passes into the buffer not being emitted
+        void task(int t) {
+            const int fwd = fft.passes() - 1;
+            float* re = slot(fdl, head);
+            if (t < fwd) {
+                fft.forward_pass(t + 1, window.data(), re, re + stride);
+            } else if (t < fwd + parts) {
+                mac(t - fwd);
+            } else {
+                const int i = t - fwd - parts;
+                fft.inverse_pass(i, acc.data(), acc.data() + stride, time[cur ^ 1].data());
+                if (i == 0) std::fill(acc.begin(), acc.end(), 0.0f);
+            }
+        }
+
+        void emit(float* dst, int block) {
+            const float* src = &time[cur][size + phase * block];
+            for (int i = 0; i < block; i++) dst[i] += src[i];
+        }
+
+        void run(float* dst, int block) {
+            if (offset == 0) {
+                // Partitions of one block: the window that completes this
+                // call is out this call
+                head = head + 1 == parts ? 0 : head + 1;
+                float* re = slot(fdl, head);
+                fft.forward(window.data(), re, re + stride);
+                for (int p = 0; p < parts; p++) mac(p);
+                fft.inverse(acc.data(), acc.data() + stride, time[0].data());
+                std::fill(acc.begin(), acc.end(), 0.0f);
+                std::copy(window.begin() + size, window.end(), window.begin());
+                emit(dst, block);
+                return;
+            }
+
+            // The window that completed two periods ago, while the one before
+            // this period's start runs its share of tasks
+            emit(dst, block);
+            const int target = (phase + 1) * tasks / calls;
+            for (; done < target; done++) task(done);
+            if (phase == calls - 1) {
+                cur ^= 1;
+                head = head + 1 == parts ? 0 : head + 1;
+                float* re = slot(fdl, head);
+                fft.forward_pass(0, window.data(), re, re + stride);
+                std::copy(window.begin() + size, window.end(), window.begin());
+                done = 0;
+                phase = 0;
+            } else {
+                phase++;
+            }
+        }
+    };
+
+    int block_;
+    std::vector<Stage> stages_;
+};
+
+} // namespace conv
+
+#endif // DSP_CONVOLVER_H
@@ -0,0 +1,164 @@
+// Delay lines on power-of-two buffers: positions wrap with a mask instead of
+// the integer % of the reverbs' circular buffers. Any delay up to the buffer
+// size is available, so a comb keeps its exact length in a buffer rounded up
+// to the next power of two (10000 -> 16384). Reads and writes go through a
+// storage codec, so a line can hold its samples as float, as 16-bit Q2.13
+// fixed point or as bfloat16. The 16-bit codecs halve a line against float
+// in the same buffer, but the rounding up can take back part of that: the
+// six 10000-sample combs of C++/6.cpp hold 234 KB as float in exact
+// buffers, 384 KB as float in power-of-two ones and 192 KB as 16-bit.
+// Plain C++ with no intrinsics, so synthesizable kernels can include it too:
+// FixedDelay owns its buffer as an array member (a BRAM on the FPGA).
+// DelayLine is the same line over caller-provided memory, for host code that
+// carves many lines out of one arena (host/arena.h).
+
+#ifndef DSP_DELAY_H
+#define DSP_DELAY_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace delay {
+
+constexpr uint32_t pow2_at_least(uint32_t n) {
+    uint32_t size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+// Storage codecs: value_type in and out, storage_type in the buffer
+
+// Stores values as they are (float, or ap_fixed in the kernels)
+template <typename T>
+struct Raw {
+    typedef T value_type;
+    typedef T storage_type;
+    static storage_type encode(value_type x) { return x; }
+    static value_type decode(storage_type v) { return v; }
+};
+
+typedef Raw<float> F32;
+
+// Q2.13 in an int16: [-4, 4) in steps of 2^-13 (-78 dB relative to full
+// scale), with saturation, so two bits of headroom for comb feedback
+// build-up. Rounds to nearest even by adding 1.5 * 2^23, which leaves the
+// integer in the low bits of the float: no branches, so loops over a line
+// vectorize.
+struct Q2_13 {
+    typedef float value_type;
+    typedef int16_t storage_type;
+    static storage_type encode(float x) {
+        float s = x * 8192.0f;
+        s = s < -32768.0f ? -32768.0f : s;
+        s = s > 32767.0f ? 32767.0f : s;
+        const float r = s + 12582912.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &r, 4);
+        return (int16_t)(uint16_t)bits;
+    }
+    static float decode(storage_type v) { return v * (1.0f / 8192.0f); }
+};
+
+// Top half of a float, rounded to nearest even: full float range, 8 bits of
+// mantissa (relative error 2^-9)
+struct BF16 {
+    typedef float value_type;
+    typedef uint16_t storage_type;
+    static storage_type encode(float x) {
+        uint32_t bits;
+        std::memcpy(&bits, &x, 4);
+        bits += 0x7FFFu + ((bits >> 16) & 1u);
+        return (uint16_t)(bits >> 16);
+    }
+    static float decode(storage_type v) {
+        const uint32_t bits = (uint32_t)v << 16;
+        float x;
+        std::memcpy(&x, &bits, 4);
+        return x;
+    }
+};
+
+// A line over a power-of-two buffer owned by someone else
+template <typename Codec = F32>
+class DelayLine {
+public:
+    typedef typename Codec::value_type value_type;
+    typedef typename Codec::storage_type storage_type;
+
+    DelayLine() : buf_(0), mask_(0), pos_(0) {}
+    // size must be a power of two; the buffer is cleared
+    DelayLine(storage_type* buf, uint32_t size) : buf_(buf), mask_(size - 1), pos_(0) {
+        for (uint32_t i = 0; i < size; ++i) buf_[i] = Codec::encode(value_type(0));
+    }
+
+    uint32_t size() const { return mask_ + 1; }
+
+    // The value written d samples ago, 1 <= d <= size()
+    value_type read(uint32_t d) const { return Codec::decode(buf_[(pos_ - d) & mask_]); }
+
+    void write(value_type x) {
+        buf_[pos_ & mask_] = Codec::encode(x);
+        pos_++;
+    }
+
+private:
+    storage_type* buf_;
+    uint32_t mask_;
+    uint32_t pos_;
+};
+
+// A line that holds up to MaxDelay samples in its own array. With Guard > 0
+// the array also keeps a copy of its first Guard samples past its end, and
+// is 64-byte aligned, so host code can load and store runs of up to Guard
+// samples as vectors without wrapping: tap() to read, head() and commit() to
+// write.
+template <uint32_t MaxDelay, typename Codec = F32, uint32_t Guard = 0>
+class FixedDelay {
+public:
+    typedef typename Codec::value_type value_type;
+    typedef typename Codec::storage_type storage_type;
+    static const uint32_t kSize = pow2_at_least(MaxDelay);
+
+    FixedDelay() : pos_(0) {
+        for (uint32_t i = 0; i < kSize + Guard; ++i) buf_[i] = Codec::encode(value_type(0));
+    }
+
+    uint32_t size() const { return kSize; }
+    uint32_t pos() const { return pos_; }  // Samples written so far
+
+    // The value written d samples ago, 1 <= d <= kSize
+    value_type read(uint32_t d) const { return Codec::decode(buf_[(pos_ - d) & (kSize - 1)]); }
+
+    void write(value_type x) {
+        const uint32_t p = pos_ & (kSize - 1);
+        buf_[p] = Codec::encode(x);
+        if (Guard > 0 && p < Guard) buf_[kSize + p] = buf_[p];
+        pos_++;
+    }
+
+    // The stored samples from the one written d samples ago on: n <= Guard
+    // of them in a row, all written already if n <= d
+    const storage_type* tap(uint32_t d) const { return &buf_[(pos_ - d) & (kSize - 1)]; }
+
+    // Where the next samples go, for a caller that stores n of them there
+    // and then calls commit(n). n <= Guard divides pos(), so the run does
+    // not wrap; head() is 64-byte aligned when n * sizeof(storage_type) is
+    // a multiple of 64.
+    storage_type* head() { return &buf_[pos_ & (kSize - 1)]; }
+
+    void commit(uint32_t n) {
+        const uint32_t p = pos_ & (kSize - 1);
+        if (p < Guard) {
+            for (uint32_t i = 0; i < n; ++i) buf_[kSize + p + i] = buf_[p + i];
+        }
+        pos_ += n;
+    }
+
+private:
+    alignas(Guard > 0 ? 64 : alignof(storage_type)) storage_type buf_[kSize + Guard];
+    uint32_t pos_;
+};
+
+} // namespace delay
+
+#endif // DSP_DELAY_H
@@ -0,0 +1,180 @@
+// Table-driven envelope shapes for the kernels and the host engines.
+// Plain C++ with no intrinsics, so synthesizable kernels can include it too:
+// the tables are computed at compile time (constexpr) and become ROMs.
+//
+// A table holds one envelope from start to end in ENV_TABLE_SIZE steps plus a
+// guard point, and is read through a 32-bit phase: the top ENV_TABLE_BITS
+// bits pick the point, the rest interpolate linearly to the next one. A
+// one-shot envelope of D samples advances the phase by 2^32 / D per sample
+// and holds the last point once the phase saturates.
+
+#ifndef DSP_ENVELOPE_H
+#define DSP_ENVELOPE_H
+
+#include <cstdint>
+
+// log2 of the points per table (1024 by default: linear interpolation of a
+// Hann window is then within 2.4e-6)
+#ifndef ENV_TABLE_BITS
+#define ENV_TABLE_BITS 10
+#endif
+
+namespace env {
+
+constexpr int kTableBits = ENV_TABLE_BITS;
+constexpr int kTableSize = 1 << kTableBits;
+constexpr int kFracBits = 32 - kTableBits;
+
+struct Table {
+    float v[kTableSize + 1];
+};
+
+// constexpr stand-ins for cos and exp (std:: ones are not constexpr), in
+// double and accurate to ~1e-13 over the ranges the shapes use
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double round_cx(double x) {
+    return x >= 0.0 ? (double)(long long)(x + 0.5) : -(double)(long long)(0.5 - x);
+}
+
+constexpr double cos_cx(double x) {
+    x -= 2.0 * kPi * round_cx(x / (2.0 * kPi));  // [-pi, pi]
+    const double x2 = x * x;
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 16; ++k) {
+        term *= -x2 / ((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// exp(x) = exp(x / 1024)^1024
+constexpr double exp_cx(double x) {
+    const double y = x / 1024.0;
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 12; ++k) {
+        term *= y / k;
+        sum += term;
+    }
+    for (int k = 0; k < 10; ++k) sum *= sum;
+    return sum;
+}
+
+} // namespace detail
+
+// Shapes over x in [0, 1]
+
+constexpr double hann(double x) { return 0.5 - 0.5 * detail::cos_cx(2.0 * detail::kPi * x); }
+
+// Flat top with Hann tapers over alpha of the length (alpha 1 is Hann,
+// alpha 0 a rectangle)
+constexpr double tukey(double x, double alpha) {
+    if (x < 0.5 * alpha) return 0.5 - 0.5 * detail::cos_cx(2.0 * detail::kPi * x / alpha);
+    if (x > 1.0 - 0.5 * alpha) return 0.5 - 0.5 * detail::cos_cx(2.0 * detail::kPi * (1.0 - x) / alpha);
+    return 1.0;
+}
+
+// Gaussian bell centred on 0.5, sigma in units of the length
+constexpr double gaussian(double x, double sigma) {
+    const double u = (x - 0.5) / sigma;
+    return detail::exp_cx(-0.5 * u * u);
+}
+
+// SuperCollider-style curved segment from a to b at t in [0, 1]: curve 0 is
+// linear, negative curves move fast first (exponential-like decay)
+constexpr double segment(double a, double b, double t, double curve) {
+    if (curve > -1e-3 && curve < 1e-3) return a + (b - a) * t;
+    return a + (b - a) * (1.0 - detail::exp_cx(curve * t)) / (1.0 - detail::exp_cx(curve));
+}
+
+// Percussive attack/release (Env.perc): attack and release in any unit. The
+// attack gets attack / (attack + release) of the table points, so a short
+// curved attack is coarse (10 points for 0.01 / 1: within 0.02 of the curve);
+// raise ENV_TABLE_BITS when that matters.
+constexpr double perc(double x, double attack, double release, double curve) {
+    const double a = attack / (attack + release);
+    if (x < a) return segment(0.0, 1.0, x / a, curve);
+    return segment(1.0, 0.0, (x - a) / (1.0 - a), curve);
+}
+
+// Table builders
+
+template <typename Shape>
+constexpr Table make_table(Shape shape) {
+    Table t{};
+    for (int i = 0; i <= kTableSize; ++i) t.v[i] = (float)shape((double)i / kTableSize);
+    return t;
+}
+
+constexpr Table hann_table() {
+    return make_table([](double x) { return hann(x); });
+}
+
+constexpr Table tukey_table(double alpha) {
+    return make_table([alpha](double x) { return tukey(x, alpha); });
+}
+
+constexpr Table gaussian_table(double sigma) {
+    return make_table([sigma](double x) { return gaussian(x, sigma); });
+}
+
+constexpr Table perc_table(double attack, double release, double curve) {
+    return make_table([=](double x) { return perc(x, attack, release, curve); });
+}
+
+// Playback
+
+// Phase increment for an envelope lasting dur_samples (>= 1)
+constexpr uint32_t phase_inc(double dur_samples) {
+    return dur_samples <= 1.0 ? 0xFFFFFFFFu : (uint32_t)(4294967296.0 / dur_samples);
+}
+
+inline float lookup(const Table& t, uint32_t phase) {
+    const uint32_t i = phase >> kFracBits;
+    const float frac = (float)(phase & ((1u << kFracBits) - 1)) * (1.0f / (1u << kFracBits));
+    return t.v[i] + (t.v[i + 1] - t.v[i]) * frac;
+}
+
+// Phase after one sample, held at the end of a one-shot envelope
+inline uint32_t advance(uint32_t phase, uint32_t inc) {
+    const uint32_t next = phase + inc;
+    return next < phase ? 0xFFFFFFFFu : next;
+}
+
+// One running envelope. render() fills a block, for callers that process
+// audio in blocks rather than sample by sample.
+struct Envelope {
+    const Table* table;
+    uint32_t phase = 0;
+    uint32_t inc = 0;
+
+    Envelope(const Table& t, double dur_samples) : table(&t), inc(phase_inc(dur_samples)) {}
+
+    void trigger() { phase = 0; }
+    bool done() const { return phase == 0xFFFFFFFFu; }
+
+    float next() {
+        const float v = lookup(*table, phase);
+        phase = advance(phase, inc);
+        return v;
+    }
+
+    void render(float* out, int n) {
+        // Samples before the phase would saturate run without the end check
+        const uint32_t left = inc ? (0xFFFFFFFFu - phase) / inc : 0xFFFFFFFFu;
+        const int free_run = left < (uint32_t)n ? (int)left : n;
+        uint32_t p = phase;
+        for (int s = 0; s < free_run; ++s) {
+            out[s] = lookup(*table, p);
+            p += inc;
+        }
+        phase = p;
+        for (int s = free_run; s < n; ++s) out[s] = next();
+    }
+};
+
+} // namespace env
+
+#endif // DSP_ENVELOPE_H
@@ -0,0 +1,156 @@
+// Feedback delay network reverb (Jot): N delay lines of mutually prime
+// lengths whose outputs are mixed by an orthogonal Hadamard matrix and fed
+// back. Each line's output is attenuated for its own length so that every
+// path through the network decays by 60 dB in the same time (RT60). The input
+// feeds every line and the output is the sum of the line outputs over
+// sqrt(N), so any number of sources can share one network through a send bus:
+// sum them, then run the network once per sample.
+// Plain C++ with no intrinsics, so synthesizable kernels can include it too.
+// N is 4 or 8, and the lines hold 2048 samples (up to 42 ms at 44.1 kHz).
+// The Hadamard is log2(N) stages of adds and subtracts: its 1/sqrt(N) scale is
+// folded into the line gains. The sample type follows the line codec, so
+// delay::Raw<ap_fixed<16,4>> gives a fixed-point network. With float lines
+// (delay::F32), host code can also run blocks of simd::kWidth frames. Every
+// line is longer than a block, so a block's delayed samples are all written
+// already, and each line is a vector along time: one load, a few adds and
+// one store per line per block. Each line keeps a copy of its first
+// kGuard samples past its end, so block loads never wrap.
+
+#ifndef DSP_FDN_H
+#define DSP_FDN_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "delay.h"
+
+#ifndef __SYNTHESIS__
+#include <type_traits>
+#include "simd.h"
+#endif
+
+namespace fdn {
+
+// Prime delay lengths in samples, 31..42 ms at 44.1 kHz
+const int kDelays4[4] = {1361, 1523, 1699, 1867};
+const int kDelays8[8] = {1031, 1129, 1259, 1361, 1489, 1601, 1741, 1867};
+
+// Unnormalized fast Walsh-Hadamard transform of x[0..N), in place
+template <int N, typename T>
+inline void hadamard(T* x) {
+    for (int h = 1; h < N; h <<= 1) {
+        for (int i = 0; i < N; i += 2 * h) {
+            for (int j = i; j < i + h; j++) {
+                T a = x[j] + x[j + h];
+                x[j + h] = x[j] - x[j + h];
+                x[j] = a;
+            }
+        }
+    }
+}
+
+template <int N, typename Codec = delay::F32>
+class Fdn {
+public:
+    static_assert(N == 4 || N == 8, "Fdn supports 4 or 8 lines");
+    typedef typename Codec::value_type value_type;
+    typedef typename Codec::storage_type storage_type;
+    static const int kSize = 2048;   // Power of two above the longest delay
+    static const int kGuard = 16;    // Widest simd::kWidth
+
+    // rt60 in seconds
+    explicit Fdn(float rt60 = 2.0f, float sample_rate = 44100.0f) : pos_(0) {
+        for (int i = 0; i < N; i++) {
+            delay_[i] = N == 4 ? kDelays4[i] : kDelays8[i];
+            for (int k = 0; k < kSize + kGuard; k++) line_[i][k] = Codec::encode(value_type(0));
+        }
+        set_rt60(rt60, sample_rate);
+    }
+
+    void set_rt60(float rt60, float sample_rate = 44100.0f) {
+        for (int i = 0; i < N; i++) {
+            // 10^(-3 D / (rt60 * sr)) per pass, and the Hadamard's 1/sqrt(N)
+            const double g = std::pow(10.0, -3.0 * delay_[i] / (rt60 * sample_rate)) / std::sqrt((double)N);
+            gain_[i] = value_type(g);
+            gain_f_[i] = (float)g;
+        }
+        out_gain_ = value_type(1.0 / std::sqrt((double)N));
+        out_gain_f_ = (float)(1.0 / std::sqrt((double)N));
+    }
+
+    // One sample in, the sum of the line outputs over sqrt(N) out
+    value_type process(value_type x) {
+        value_type y[N];
+        value_type sum = 0;
+        for (int i = 0; i < N; i++) {
+            #pragma HLS UNROLL
+            value_type d = Codec::decode(line_[i][(pos_ - delay_[i]) & (kSize - 1)]);
+            sum += d;
+            y[i] = d * gain_[i];
+        }
+        hadamard<N>(y);
+        for (int i = 0; i < N; i++) {
+            #pragma HLS UNROLL
+            put(line_[i], x + y[i]);
+        }
+        ++pos_;
+        return sum * out_gain_;
+    }
+
+#ifndef __SYNTHESIS__
+    // n samples from in to out (may alias); the same output as n calls of
+    // process(x). Float lines only.
+    void process(const float* in, float* out, int n) {
+        static_assert(std::is_same<Codec, delay::F32>::value, "block processing needs float lines");
+        const int W = simd::kWidth;
+        int i = 0;
+        for (; i < n && (pos_ & (W - 1)) != 0; i++) out[i] = process(in[i]);
+        for (; i + W <= n; i += W) process_block(in + i, out + i);
+        for (; i < n; i++) out[i] = process(in[i]);
+    }
+#endif
+
+private:
+    storage_type line_[N][kSize + kGuard];
+    int delay_[N];
+    value_type gain_[N];
+    float gain_f_[N];
+    value_type out_gain_;
+    float out_gain_f_;
+    uint32_t pos_;
+
+    // Writes sample pos_ of a line and its guard copy
+    void put(storage_type* line, value_type x) {
+        uint32_t p = pos_ & (kSize - 1);
+        line[p] = Codec::encode(x);
+        if (p < kGuard) line[kSize + p] = line[p];
+    }
+
+#ifndef __SYNTHESIS__
+    // simd::kWidth samples from a block boundary (pos_ a multiple of kWidth)
+    void process_block(const float* in, float* out) {
+        const int W = simd::kWidth;
+        const uint32_t p = pos_ & (kSize - 1);
+        simd::vfloat y[N];
+        simd::vfloat sum = simd::zero();
+        for (int i = 0; i < N; i++) {
+            const simd::vfloat d = simd::loadu(&line_[i][(pos_ - delay_[i]) & (kSize - 1)]);
+            sum += d;
+            y[i] = d * simd::set1(gain_f_[i]);
+        }
+        hadamard<N>(y);
+        const simd::vfloat x = simd::loadu(in);
+        for (int i = 0; i < N; i++) {
+            const simd::vfloat w = x + y[i];
+            simd::storeu(&line_[i][p], w);
+            if (p < kGuard) simd::storeu(&line_[i][kSize + p], w);
+        }
+        simd::storeu(out, sum * simd::set1(out_gain_f_));
+        pos_ += W;
+    }
+#endif
+};
+
+} // namespace fdn
+
+#endif // DSP_FDN_H
@@ -0,0 +1,204 @@
+// Real FFT for the host-side convolution engine (dsp/convolver.h).
+// A real transform of n points runs as a complex transform of n / 2 points
+// on the even/odd sample pairs, then one pass that splits the two halves
+// apart. The complex transform is a Stockham auto-sort FFT: radix-4 stages,
+// plus one radix-2 stage when log2(n / 2) is odd. Every stage reads one
+// buffer and writes the other, so there is no bit-reversal pass, and the
+// output comes out in natural order. Spectra are split: re[0..n/2] and
+// im[0..n/2].
+// Neither direction is normalized: inverse(forward(x)) is n * x. Either
+// direction also runs as a sequence of passes, so a caller can spread one
+// transform over several calls. The tables and scratch buffers are allocated
+// by the constructor, so forward() and inverse() never allocate; they share
+// the scratch, so one RealFft serves one thread. Not for HLS: kernels only
+// include this under #ifndef __SYNTHESIS__.
+
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#include <cmath>
+#include <vector>
+
+namespace fft {
+
+namespace detail {
+
+const double kTwoPi = 6.283185307179586;
+
+} // namespace detail
+
+class RealFft {
+public:
+    // n a power of two, at least 4
+    explicit RealFft(int n) : n_(n), m_(n / 2), stages_(0) {
+        // Stage twiddles W_len^p, W_len^2p, W_len^3p for each radix-4 stage
+        for (int len = m_; len >= 2; len /= 4) {
+            tw_offset_.push_back((int)tw_re_.size());
+            stages_++;
+            for (int p = 0; len >= 4 && p < len / 4; ++p) {
+                for (int k = 1; k <= 3; ++k) {
+                    const double a = -detail::kTwoPi * k * p / len;
+                    tw_re_.push_back((float)std::cos(a));
+                    tw_im_.push_back((float)std::sin(a));
+                }
+            }
+        }
+        // W_n^k for the split pass
+        for (int k = 0; k <= m_; ++k) {
+            const double a = -detail::kTwoPi * k / n_;
+            split_re_.push_back((float)std::cos(a));
+            split_im_.push_back((float)std::sin(a));
+        }
+        for (int i = 0; i < 4; ++i) buf_[i].assign(m_, 0.0f);
+    }
+
+    int size() const { return n_; }
+    int bins() const { return m_ + 1; }
+
+    // x[0..n) to re/im[0..n/2]
+    void forward(const float* x, float* re, float* im) {
+        for (int i = 0; i < passes(); ++i) forward_pass(i, x, re, im);
+    }
+
+    // re/im[0..n/2] to x[0..n), times n
+    void inverse(const float* re, const float* im, float* x) {
+        for (int i = 0; i < passes(); ++i) inverse_pass(i, re, im, x);
+    }
+
+    // The same transforms as passes() steps of similar cost (one pass over
+    // n / 2 points each), for callers that spread one transform over several
+    // calls: forward_pass(i, ...) for i = 0 .. passes() - 1 in order is
+    // forward(), and likewise for inverse_pass(). Pass 0 only reads the input
+    // and the last pass only writes the output. The transform in flight lives
+    // in the scratch, so one RealFft runs one transform at a time.
+    int passes() const { return stages_ + 2; }
+
+    void forward_pass(int i, const float* x, float* re, float* im) {
+        if (i == 0) {
+            float* zr = buf_[0].data();
+            float* zi = buf_[1].data();
+            for (int k = 0; k < m_; ++k) {
+                zr[k] = x[2 * k];
+                zi[k] = x[2 * k + 1];
+            }
+        } else if (i <= stages_) {
+            const int a = (i - 1) % 2 * 2, b = 2 - a;
+            fft_stage(i - 1, buf_[a].data(), buf_[a + 1].data(), buf_[b].data(), buf_[b + 1].data());
+        } else {
+            // Z = E + iO, with E and O the transforms of the even and odd
+            // samples: X[k] = E[k] + W_n^k O[k]
+            const float* zr = buf_[result()].data();
+            const float* zi = buf_[result() + 1].data();
+            for (int k = 0; k <= m_ / 2; ++k) {
+                const int j = k == 0 ? 0 : m_ - k;
+                const float ar = zr[k], ai = zi[k], br = zr[j], bi = zi[j];
+                const float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);   // E[k]
+                const float or_ = 0.5f * (ai + bi), oi = 0.5f * (br - ar);  // O[k]
+                const float wr = split_re_[k], wi = split_im_[k];
+                const float tr = wr * or_ - wi * oi, ti = wr * oi + wi * or_;
+                re[k] = er + tr;
+                im[k] = ei + ti;
+                // X[m - k] = conj(E[k]) + W_n^(m-k) conj(O[k]) = conj(E[k] - W_n^k O[k])
+                re[m_ - k] = er - tr;
+                im[m_ - k] = -(ei - ti);
+            }
+            re[0] = zr[0] + zi[0];
+            im[0] = 0.0f;
+            re[m_] = zr[0] - zi[0];
+            im[m_] = 0.0f;
+        }
+    }
+
+    void inverse_pass(int i, const float* re, const float* im, float* x) {
+        if (i == 0) {
+            float* zr = buf_[0].data();
+            float* zi = buf_[1].data();
+            // Rebuild Z[k] = E[k] + i O[k] from X[k] and conj(X[m - k])
+            for (int k = 0; k < m_; ++k) {
+                const float ar = re[k], ai = im[k], br = re[m_ - k], bi = -im[m_ - k];
+                const float er = ar + br, ei = ai + bi;                      // 2 E[k]
+                const float dr = ar - br, di = ai - bi;                      // 2 W_n^k O[k]
+                const float wr = split_re_[k], wi = -split_im_[k];           // W_n^-k
+                const float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;  // 2 O[k]
+                zr[k] = er - oi;
+                zi[k] = ei + or_;
+            }
+        } else if (i <= stages_) {
+            // Inverse by the forward transform with re and im swapped
+            const int a = (i - 1) % 2 * 2, b = 2 - a;
+            fft_stage(i - 1, buf_[a + 1].data(), buf_[a].data(), buf_[b + 1].data(), buf_[b].data());
+        } else {
+            const float* zr = buf_[result()].data();
+            const float* zi = buf_[result() + 1].data();
+            for (int k = 0; k < m_; ++k) {
+                x[2 * k] = zr[k];
+                x[2 * k + 1] = zi[k];
+            }
+        }
+    }
+
+private:
+    int n_, m_;
+    int stages_;                   // Radix-4 stages, plus a radix-2 one when log2(n / 2) is odd
+    std::vector<int> tw_offset_;   // First twiddle of each stage
+    std::vector<float> tw_re_, tw_im_, split_re_, split_im_;
+    std::vector<float> buf_[4];    // Two re/im pairs the stages alternate between
+
+    // First buffer of the pair holding the complex transform after the last stage
+    int result() const { return stages_ % 2 * 2; }
+
+    // Stage i of the forward complex FFT of n / 2 points, from x to y
+    void fft_stage(int i, const float* xr, const float* xi, float* yr, float* yi) const {
+        int s = 1;
+        for (int k = 0; k < i; ++k) s *= 4;
+        const int len = m_ / s;
+        if (len == 2) {
+            // Last radix-2 stage
+            for (int q = 0; q < s; ++q) {
+                const float ar = xr[q], ai = xi[q], br = xr[q + s], bi = xi[q + s];
+                yr[q] = ar + br;
+                yi[q] = ai + bi;
+                yr[q + s] = ar - br;
+                yi[q + s] = ai - bi;
+            }
+            return;
+        }
+        const float* wr = tw_re_.data() + tw_offset_[i];
+        const float* wi = tw_im_.data() + tw_offset_[i];
+        const int q4 = len / 4;
+        for (int p = 0; p < q4; ++p) {
+            const float w1r = wr[3 * p], w1i = wi[3 * p];
+            const float w2r = wr[3 * p + 1], w2i = wi[3 * p + 1];
+            const float w3r = wr[3 * p + 2], w3i = wi[3 * p + 2];
+            const float* ar = xr + s * p;
+            const float* ai = xi + s * p;
+            float* outr = yr + s * 4 * p;
+            float* outi = yi + s * 4 * p;
+            for (int q = 0; q < s; ++q) {
+                const float a0r = ar[q], a0i = ai[q];
+                const float a1r = ar[q + s * q4], a1i = ai[q + s * q4];
+                const float a2r = ar[q + 2 * s * q4], a2i = ai[q + 2 * s * q4];
+                const float a3r = ar[q + 3 * s * q4], a3i = ai[q + 3 * s * q4];
+                const float t0r = a0r + a2r, t0i = a0i + a2i;
+                const float t1r = a0r - a2r, t1i = a0i - a2i;
+                const float t2r = a1r + a3r, t2i = a1i + a3i;
+                const float t3r = a1i - a3i, t3i = a3r - a1r;  // -i (a1 - a3)
+                const float b1r = t1r + t3r, b1i = t1i + t3i;
+                const float b2r = t0r - t2r, b2i = t0i - t2i;
+                const float b3r = t1r - t3r, b3i = t1i - t3i;
+                outr[q] = t0r + t2r;
+                outi[q] = t0i + t2i;
+                outr[q + s] = w1r * b1r - w1i * b1i;
+                outi[q + s] = w1r * b1i + w1i * b1r;
+                outr[q + 2 * s] = w2r * b2r - w2i * b2i;
+                outi[q + 2 * s] = w2r * b2i + w2i * b2r;
+                outr[q + 3 * s] = w3r * b3r - w3i * b3i;
+                outi[q + 3 * s] = w3r * b3i + w3i * b3r;
+            }
+        }
+    }
+};
+
+} // namespace fft
+
+#endif // DSP_FFT_H
@@ -0,0 +1,173 @@
+// Sample and phase types for the templated synth kernels (C++/1.cpp, 2.cpp
+// and 3.cpp). The same kernel source can be instantiated on float, double,
+// any ap_fixed<W,I>, or the integer Q formats defined here. Q15 is int16 and
+// Q31 is int32, with 15 and 31 fraction bits.
+// Q arithmetic wraps, as ap_fixed's default AP_WRAP does. Products are
+// computed in the next wider integer, then shifted right with truncation
+// (AP_TRN). Conversion from floating point rounds to nearest.
+// Phases count turns (one period is 1.0), so an oscillator steps by
+// freq / sample_rate. wrap_turns() brings a phase back into [0, 1). The Q
+// formats and ap_ufixed<W,0> need no wrap: they wrap through their own
+// overflow.
+// Plain C++ with no intrinsics, so synthesizable kernels can include it too.
+
+#ifndef DSP_NUMERIC_H
+#define DSP_NUMERIC_H
+
+#include <cmath>
+#include <cstdint>
+
+#include <ap_fixed.h>
+#include <hls_math.h>
+
+#include "sine.h"
+
+namespace num {
+
+namespace detail {
+
+template <typename Int> struct wider;
+template <> struct wider<int16_t> { typedef int32_t type; };
+template <> struct wider<int32_t> { typedef int64_t type; };
+template <> struct wider<int64_t> { typedef int64_t type; };  // Accumulators only: no products
+
+const double kTwoPi = 6.283185307179586;
+
+// A fixed-point phase with Frac fraction bits, raw, as a 32-bit phase: the
+// integer bits (whole turns) drop out
+template <int Frac>
+inline uint32_t phase_bits(uint64_t raw) {
+    return (uint32_t)(raw << (Frac < 32 ? 32 - Frac : 0) >> (Frac > 32 ? Frac - 32 : 0));
+}
+
+} // namespace detail
+
+template <typename Int, int Frac>
+class Q {
+public:
+    typedef typename detail::wider<Int>::type wide_type;
+    static const int frac_bits = Frac;
+
+    Int v;  // Raw value, scaled by 2^Frac
+
+    Q() : v(0) {}
+    Q(double x) : v((Int)(wide_type)std::floor(std::ldexp(x, Frac) + 0.5)) {}
+    Q(float x) : Q((double)x) {}
+    Q(int x) : Q((double)x) {}
+    // Between widths of the same scale (accumulator and sample), as
+    // ap_fixed converts between widths
+    template <typename Int2>
+    Q(const Q<Int2, Frac>& o) : v((Int)o.v) {}
+
+    static Q from_raw(Int r) { Q q; q.v = r; return q; }
+    double to_double() const { return std::ldexp((double)v, -Frac); }
+    explicit operator double() const { return to_double(); }
+    explicit operator float() const { return (float)to_double(); }
+
+    Q operator-() const { return from_raw((Int)-(wide_type)v); }
+    Q& operator+=(Q o) { v = (Int)((wide_type)v + o.v); return *this; }
+    Q& operator-=(Q o) { v = (Int)((wide_type)v - o.v); return *this; }
+    Q& operator*=(Q o) { v = (Int)(((wide_type)v * o.v) >> Frac); return *this; }
+    Q& operator/=(int n) { v = (Int)(v / n); return *this; }
+};
+
+template <typename Int, int Frac> inline Q<Int, Frac> operator+(Q<Int, Frac> a, Q<Int, Frac> b) { return a += b; }
+template <typename Int, int Frac> inline Q<Int, Frac> operator-(Q<Int, Frac> a, Q<Int, Frac> b) { return a -= b; }
+template <typename Int, int Frac> inline Q<Int, Frac> operator*(Q<Int, Frac> a, Q<Int, Frac> b) { return a *= b; }
+template <typename Int, int Frac> inline Q<Int, Frac> operator/(Q<Int, Frac> a, int n) { return a /= n; }
+template <typename Int, int Frac> inline bool operator<(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v < b.v; }
+template <typename Int, int Frac> inline bool operator>(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v > b.v; }
+template <typename Int, int Frac> inline bool operator<=(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v <= b.v; }
+template <typename Int, int Frac> inline bool operator>=(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v >= b.v; }
+template <typename Int, int Frac> inline bool operator==(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v == b.v; }
+template <typename Int, int Frac> inline bool operator!=(Q<Int, Frac> a, Q<Int, Frac> b) { return a.v != b.v; }
+
+typedef Q<int16_t, 15> Q15;
+typedef Q<int32_t, 31> Q31;
+
+// accum_type sums many samples without overflow: at least 4 more integer
+// bits at the same resolution
+template <typename T>
+struct Traits {
+    typedef T accum_type;  // float, double
+};
+
+// On ap_fixed and ap_ufixed themselves: they derive from ap_fixed_base, and a
+// specialization on the base would not match them
+template <int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+struct Traits<ap_fixed<W, I, Qm, O, N>> {
+    typedef ap_fixed<W + 4, I + 4, Qm, O, N> accum_type;
+};
+
+template <int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+struct Traits<ap_ufixed<W, I, Qm, O, N>> {
+    typedef ap_ufixed<W + 4, I + 4, Qm, O, N> accum_type;
+};
+
+template <typename Int, int Frac>
+struct Traits<Q<Int, Frac>> {
+    typedef Q<typename detail::wider<Int>::type, Frac> accum_type;
+};
+
+// Any of the types above to any other, through double
+template <typename To, typename From>
+inline To cast(const From& x) { return To((double)x); }
+
+// Phase back into [0, 1) turns after one step of at most a turn
+template <typename T>
+inline void wrap_turns(T& p) {
+    if (p >= T(1)) p -= T(1);
+}
+
+template <int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+inline void wrap_turns(ap_fixed<W, I, Qm, O, N>& p) {
+    if (I > 0 && p.to_double() >= 1.0) p -= 1.0;  // Narrower types wrap on overflow
+}
+
+template <int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+inline void wrap_turns(ap_ufixed<W, I, Qm, O, N>& p) {
+    if (I > 0 && p.to_double() >= 1.0) p -= 1.0;  // Narrower types wrap on overflow
+}
+
+template <typename Int, int Frac>
+inline void wrap_turns(Q<Int, Frac>&) {}
+
+// sin(2 pi p) for a phase p in turns, in sample type S: SINE_POLICY
+// (dsp/sine.h) on the phase as 32 bits. The fixed-point phases give their
+// fraction bits straight from the raw value, with no conversion through
+// double (a floating-point multiplier in hardware). Double phases
+// keep double precision hls::sin, the reference of
+// bench/precision_bench.cpp.
+template <typename S, typename P>
+inline S sin_turns(const P& p) {
+    return cast<S>(sine::Default::sin(sine::phase_of((double)p)));
+}
+
+template <typename S, int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+inline S sin_turns(const ap_fixed<W, I, Qm, O, N>& p) {
+    return cast<S>(sine::Default::sin(detail::phase_bits<W - I>((uint64_t)p.V)));
+}
+
+template <typename S, int W, int I, ap_q_mode Qm, ap_o_mode O, int N>
+inline S sin_turns(const ap_ufixed<W, I, Qm, O, N>& p) {
+    return cast<S>(sine::Default::sin(detail::phase_bits<W - I>((uint64_t)p.V)));
+}
+
+template <typename S, typename Int, int Frac>
+inline S sin_turns(const Q<Int, Frac>& p) {
+    return cast<S>(sine::Default::sin(detail::phase_bits<Frac>((uint64_t)(int64_t)p.v)));
+}
+
+template <typename S>
+inline S sin_turns(const float& p) {
+    return cast<S>(sine::Default::sin(sine::phase_of(p)));
+}
+
+template <typename S>
+inline S sin_turns(const double& p) {
+    return cast<S>(hls::sin(detail::kTwoPi * p));
+}
+
+} // namespace num
+
+#endif // DSP_NUMERIC_H
@@ -0,0 +1,421 @@
+// Portable SIMD float vector for the host-side (CPU) DSP paths.
+// The widest instruction set enabled at compile time is used:
+//   AVX-512F  -> 16 lanes   (build with -mavx512f or -march=native)
+//   AVX2+FMA  ->  8 lanes   (-mavx2 -mfma)
+//   SSE2      ->  4 lanes   (x86-64 baseline)
+//   otherwise ->  1 lane    (plain C++)
+// Code written against simd::vfloat and simd::kWidth compiles unchanged on all
+// of them. Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef DSP_SIMD_H
+#define DSP_SIMD_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define DSP_SIMD_AVX512 1
+#elif defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DSP_SIMD_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DSP_SIMD_SSE2 1
+#else
+#define DSP_SIMD_SCALAR 1
+#endif
+
+namespace simd {
+
+#if DSP_SIMD_AVX512
+constexpr int kWidth = 16;
+constexpr const char* kIsa = "avx512";
+typedef __m512 native_t;
+typedef __mmask16 mask_t;
+#elif DSP_SIMD_AVX2
+constexpr int kWidth = 8;
+constexpr const char* kIsa = "avx2";
+typedef __m256 native_t;
+typedef __m256 mask_t;
+#elif DSP_SIMD_SSE2
+constexpr int kWidth = 4;
+constexpr const char* kIsa = "sse2";
+typedef __m128 native_t;
+typedef __m128 mask_t;
+#else
+constexpr int kWidth = 1;
+constexpr const char* kIsa = "scalar";
+typedef float native_t;
+typedef bool mask_t;
+#endif
+
+// Alignment that satisfies aligned loads/stores for the selected width.
+constexpr std::size_t kAlign = kWidth * sizeof(float) < 16 ? 16 : kWidth * sizeof(float);
+
+struct vmask {
+    mask_t m;
+};
+
+struct vfloat {
+    native_t v;
+
+    vfloat() {}
+    vfloat(native_t x) : v(x) {}
+};
+
+// Construction / memory
+#if DSP_SIMD_AVX512
+inline vfloat set1(float x) { return _mm512_set1_ps(x); }
+inline vfloat zero() { return _mm512_setzero_ps(); }
+inline vfloat load(const float* p) { return _mm512_load_ps(p); }
+inline vfloat loadu(const float* p) { return _mm512_loadu_ps(p); }
+inline void store(float* p, vfloat a) { _mm512_store_ps(p, a.v); }
+inline void storeu(float* p, vfloat a) { _mm512_storeu_ps(p, a.v); }
+#elif DSP_SIMD_AVX2
+inline vfloat set1(float x) { return _mm256_set1_ps(x); }
+inline vfloat zero() { return _mm256_setzero_ps(); }
+inline vfloat load(const float* p) { return _mm256_load_ps(p); }
+inline vfloat loadu(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, vfloat a) { _mm256_store_ps(p, a.v); }
+inline void storeu(float* p, vfloat a) { _mm256_storeu_ps(p, a.v); }
+#elif DSP_SIMD_SSE2
+inline vfloat set1(float x) { return _mm_set1_ps(x); }
+inline vfloat zero() { return _mm_setzero_ps(); }
+inline vfloat load(const float* p) { return _mm_load_ps(p); }
+inline vfloat loadu(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, vfloat a) { _mm_store_ps(p, a.v); }
+inline void storeu(float* p, vfloat a) { _mm_storeu_ps(p, a.v); }
+#else
+inline vfloat set1(float x) { return x; }
+inline vfloat zero() { return 0.0f; }
+inline vfloat load(const float* p) { return *p; }
+inline vfloat loadu(const float* p) { return *p; }
+inline void store(float* p, vfloat a) { *p = a.v; }
+inline void storeu(float* p, vfloat a) { *p = a.v; }
+#endif
+
+// int16 runs, kWidth values at a time: load_i16 converts to float,
+// store_i16 rounds to nearest even and saturates (as delay::Q2_13 encodes,
+// after its scaling)
+#if DSP_SIMD_AVX512
+inline vfloat load_i16(const int16_t* p) {
+    return _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)p)));
+}
+inline void store_i16(int16_t* p, vfloat a) {
+    _mm256_storeu_si256((__m256i*)p, _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(a.v)));
+}
+#elif DSP_SIMD_AVX2
+inline vfloat load_i16(const int16_t* p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p)));
+}
+inline void store_i16(int16_t* p, vfloat a) {
+    const __m256i i = _mm256_cvtps_epi32(a.v);
+    _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+}
+#elif DSP_SIMD_SSE2
+inline vfloat load_i16(const int16_t* p) {
+    const __m128i x = _mm_loadl_epi64((const __m128i*)p);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+}
+inline void store_i16(int16_t* p, vfloat a) {
+    const __m128i i = _mm_cvtps_epi32(a.v);
+    _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(i, i));
+}
+#else
+inline vfloat load_i16(const int16_t* p) { return (float)*p; }
+inline void store_i16(int16_t* p, vfloat a) {
+    const float s = std::nearbyint(a.v);
+    *p = (int16_t)(s < -32768.0f ? -32768.0f : (s > 32767.0f ? 32767.0f : s));
+}
+#endif
+
+// 32-bit phases (2^32 per turn, as in dsp/sine.h), kWidth at a time:
+//   phase_turns(p)           p as signed turns, [-0.5, 0.5)
+//   phase_frac(p, bits)      the low bits of p as a fraction, [0, 1); bits < 32
+//   gather(base, p, shift)   base[p >> shift] in each lane
+#if DSP_SIMD_AVX512
+inline vfloat phase_turns(const uint32_t* p) {
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(p)), _mm512_set1_ps(1.0f / 4294967296.0f));
+}
+inline vfloat phase_frac(const uint32_t* p, int bits) {
+    const __m512i f = _mm512_and_si512(_mm512_loadu_si512(p), _mm512_set1_epi32((int)((1u << bits) - 1)));
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(f), _mm512_set1_ps(1.0f / (float)(1u << bits)));
+}
+inline vfloat gather(const float* base, const uint32_t* p, int shift) {
+    const __m512i i = _mm512_srl_epi32(_mm512_loadu_si512(p), _mm_cvtsi32_si128(shift));
+    return _mm512_i32gather_ps(i, base, 4);
+}
+#elif DSP_SIMD_AVX2
+inline vfloat phase_turns(const uint32_t* p) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 4294967296.0f));
+}
+inline vfloat phase_frac(const uint32_t* p, int bits) {
+    const __m256i f = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), _mm256_set1_epi32((int)((1u << bits) - 1)));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(f), _mm256_set1_ps(1.0f / (float)(1u << bits)));
+}
+inline vfloat gather(const float* base, const uint32_t* p, int shift) {
+    const __m256i i = _mm256_srl_epi32(_mm256_loadu_si256((const __m256i*)p), _mm_cvtsi32_si128(shift));
+    return _mm256_i32gather_ps(base, i, 4);
+}
+#elif DSP_SIMD_SSE2
+inline vfloat phase_turns(const uint32_t* p) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)p);
+    return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 4294967296.0f));
+}
+inline vfloat phase_frac(const uint32_t* p, int bits) {
+    const __m128i f = _mm_and_si128(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi32((int)((1u << bits) - 1)));
+    return _mm_mul_ps(_mm_cvtepi32_ps(f), _mm_set1_ps(1.0f / (float)(1u << bits)));
+}
+// No gather instruction: four scalar loads
+inline vfloat gather(const float* base, const uint32_t* p, int shift) {
+    return _mm_setr_ps(base[p[0] >> shift], base[p[1] >> shift], base[p[2] >> shift], base[p[3] >> shift]);
+}
+#else
+inline vfloat phase_turns(const uint32_t* p) { return (float)(int32_t)*p * (1.0f / 4294967296.0f); }
+inline vfloat phase_frac(const uint32_t* p, int bits) { return (float)(*p & ((1u << bits) - 1)) * (1.0f / (float)(1u << bits)); }
+inline vfloat gather(const float* base, const uint32_t* p, int shift) { return base[*p >> shift]; }
+#endif
+
+// Lane indices 0, 1, ..., kWidth-1
+inline vfloat iota() {
+    alignas(64) float lanes[kWidth];
+    for (int i = 0; i < kWidth; ++i) lanes[i] = (float)i;
+    return loadu(lanes);
+}
+
+// Arithmetic
+#if DSP_SIMD_AVX512
+inline vfloat operator+(vfloat a, vfloat b) { return _mm512_add_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a, vfloat b) { return _mm512_sub_ps(a.v, b.v); }
+inline vfloat operator*(vfloat a, vfloat b) { return _mm512_mul_ps(a.v, b.v); }
+inline vfloat operator/(vfloat a, vfloat b) { return _mm512_div_ps(a.v, b.v); }
+inline vfloat fmadd(vfloat a, vfloat b, vfloat c) { return _mm512_fmadd_ps(a.v, b.v, c.v); }
+inline vfloat min(vfloat a, vfloat b) { return _mm512_min_ps(a.v, b.v); }
+inline vfloat max(vfloat a, vfloat b) { return _mm512_max_ps(a.v, b.v); }
+inline vfloat abs(vfloat a) { return _mm512_abs_ps(a.v); }
+inline vfloat sqrt(vfloat a) { return _mm512_sqrt_ps(a.v); }
+inline vfloat floor(vfloat a) { return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+inline vfloat round(vfloat a) { return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+inline vfloat trunc(vfloat a) { return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+// 2^n for integer-valued n in [-126, 127]
+inline vfloat pow2i(vfloat n) {
+    __m512i e = _mm512_add_epi32(_mm512_cvtps_epi32(n.v), _mm512_set1_epi32(127));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(e, 23));
+}
+#elif DSP_SIMD_AVX2
+inline vfloat operator+(vfloat a, vfloat b) { return _mm256_add_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a, vfloat b) { return _mm256_sub_ps(a.v, b.v); }
+inline vfloat operator*(vfloat a, vfloat b) { return _mm256_mul_ps(a.v, b.v); }
+inline vfloat operator/(vfloat a, vfloat b) { return _mm256_div_ps(a.v, b.v); }
+inline vfloat fmadd(vfloat a, vfloat b, vfloat c) { return _mm256_fmadd_ps(a.v, b.v, c.v); }
+inline vfloat min(vfloat a, vfloat b) { return _mm256_min_ps(a.v, b.v); }
+inline vfloat max(vfloat a, vfloat b) { return _mm256_max_ps(a.v, b.v); }
+inline vfloat abs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline vfloat sqrt(vfloat a) { return _mm256_sqrt_ps(a.v); }
+inline vfloat floor(vfloat a) { return _mm256_floor_ps(a.v); }
+inline vfloat round(vfloat a) { return _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+inline vfloat trunc(vfloat a) { return _mm256_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+inline vfloat pow2i(vfloat n) {
+    __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+}
+#elif DSP_SIMD_SSE2
+inline vfloat operator+(vfloat a, vfloat b) { return _mm_add_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a, vfloat b) { return _mm_sub_ps(a.v, b.v); }
+inline vfloat operator*(vfloat a, vfloat b) { return _mm_mul_ps(a.v, b.v); }
+inline vfloat operator/(vfloat a, vfloat b) { return _mm_div_ps(a.v, b.v); }
+inline vfloat fmadd(vfloat a, vfloat b, vfloat c) { return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v); }
+inline vfloat min(vfloat a, vfloat b) { return _mm_min_ps(a.v, b.v); }
+inline vfloat max(vfloat a, vfloat b) { return _mm_max_ps(a.v, b.v); }
+inline vfloat abs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline vfloat sqrt(vfloat a) { return _mm_sqrt_ps(a.v); }
+// SSE2 has no floor/round instruction; go through int32 (valid for |a| < 2^31).
+inline vfloat floor(vfloat a) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+}
+inline vfloat round(vfloat a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)); }
+inline vfloat trunc(vfloat a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v)); }
+inline vfloat pow2i(vfloat n) {
+    __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+}
+#else
+inline vfloat operator+(vfloat a, vfloat b) { return a.v + b.v; }
+inline vfloat operator-(vfloat a, vfloat b) { return a.v - b.v; }
+inline vfloat operator*(vfloat a, vfloat b) { return a.v * b.v; }
+inline vfloat operator/(vfloat a, vfloat b) { return a.v / b.v; }
+inline vfloat fmadd(vfloat a, vfloat b, vfloat c) { return a.v * b.v + c.v; }
+inline vfloat min(vfloat a, vfloat b) { return a.v < b.v ? a.v : b.v; }
+inline vfloat max(vfloat a, vfloat b) { return a.v > b.v ? a.v : b.v; }
+inline vfloat abs(vfloat a) { return std::fabs(a.v); }
+inline vfloat sqrt(vfloat a) { return std::sqrt(a.v); }
+inline vfloat floor(vfloat a) { return std::floor(a.v); }
+inline vfloat round(vfloat a) { return std::nearbyint(a.v); }
+inline vfloat trunc(vfloat a) { return std::trunc(a.v); }
+inline vfloat pow2i(vfloat n) { return std::ldexp(1.0f, (int)n.v); }
+#endif
+
+inline vfloat operator-(vfloat a) { return zero() - a; }
+inline vfloat& operator+=(vfloat& a, vfloat b) { return a = a + b; }
+inline vfloat& operator-=(vfloat& a, vfloat b) { return a = a - b; }
+inline vfloat& operator*=(vfloat& a, vfloat b) { return a = a * b; }
+
+// Comparisons and masking
+#if DSP_SIMD_AVX512
+inline vmask operator<(vfloat a, vfloat b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline vmask operator>(vfloat a, vfloat b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)}; }
+inline vmask operator<=(vfloat a, vfloat b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)}; }
+inline vmask operator>=(vfloat a, vfloat b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)}; }
+inline vmask operator&(vmask a, vmask b) { return {(mask_t)(a.m & b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {(mask_t)(a.m | b.m)}; }
+inline vmask operator!(vmask a) { return {(mask_t)~a.m}; }
+inline vfloat select(vmask m, vfloat a, vfloat b) { return _mm512_mask_blend_ps(m.m, b.v, a.v); }
+inline int bits(vmask m) { return (int)m.m; }
+#elif DSP_SIMD_AVX2
+inline vmask operator<(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline vmask operator>(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline vmask operator<=(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+inline vmask operator>=(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+inline vmask operator&(vmask a, vmask b) { return {_mm256_and_ps(a.m, b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {_mm256_or_ps(a.m, b.m)}; }
+inline vmask operator!(vmask a) { return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+inline vfloat select(vmask m, vfloat a, vfloat b) { return _mm256_blendv_ps(b.v, a.v, m.m); }
+inline int bits(vmask m) { return _mm256_movemask_ps(m.m); }
+#elif DSP_SIMD_SSE2
+inline vmask operator<(vfloat a, vfloat b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline vmask operator>(vfloat a, vfloat b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline vmask operator<=(vfloat a, vfloat b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline vmask operator>=(vfloat a, vfloat b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline vmask operator&(vmask a, vmask b) { return {_mm_and_ps(a.m, b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {_mm_or_ps(a.m, b.m)}; }
+inline vmask operator!(vmask a) { return {_mm_xor_ps(a.m, _mm_castsi128_ps(_mm_set1_epi32(-1)))}; }
+inline vfloat select(vmask m, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)); }
+inline int bits(vmask m) { return _mm_movemask_ps(m.m); }
+#else
+inline vmask operator<(vfloat a, vfloat b) { return {a.v < b.v}; }
+inline vmask operator>(vfloat a, vfloat b) { return {a.v > b.v}; }
+inline vmask operator<=(vfloat a, vfloat b) { return {a.v <= b.v}; }
+inline vmask operator>=(vfloat a, vfloat b) { return {a.v >= b.v}; }
+inline vmask operator&(vmask a, vmask b) { return {a.m && b.m}; }
+inline vmask operator|(vmask a, vmask b) { return {a.m || b.m}; }
+inline vmask operator!(vmask a) { return {!a.m}; }
+inline vfloat select(vmask m, vfloat a, vfloat b) { return m.m ? a : b; }
+inline int bits(vmask m) { return m.m ? 1 : 0; }
+#endif
+
+inline bool any(vmask m) { return bits(m) != 0; }
+inline bool all(vmask m) { return bits(m) == (int)((1u << kWidth) - 1); }
+inline bool none(vmask m) { return bits(m) == 0; }
+
+// Horizontal sum of all lanes
+inline float hsum(vfloat a) {
+#if DSP_SIMD_AVX512
+    return _mm512_reduce_add_ps(a.v);
+#elif DSP_SIMD_AVX2
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+#elif DSP_SIMD_SSE2
+    __m128 s = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+#else
+    return a.v;
+#endif
+}
+
+// Lanes moved up by N: lane i gets lane i - N, the lowest N lanes get 0.
+// With fmadd this runs a first-order recursion along the lanes as a scan.
+template <int N>
+inline vfloat shift_up(vfloat a) {
+    if (N <= 0) return a;
+    if (N >= kWidth) return zero();
+#if DSP_SIMD_AVX512
+    return _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(a.v), _mm512_setzero_si512(), (16 - N) & 15));
+#elif DSP_SIMD_AVX2
+    // t = [0, low half of a]; lanes cross the 128-bit halves through it
+    const __m256 t = _mm256_permute2f128_ps(a.v, a.v, 0x08);
+    if (N == 4) return t;
+    if (N < 4) {
+        return _mm256_castsi256_ps(_mm256_alignr_epi8(_mm256_castps_si256(a.v), _mm256_castps_si256(t), (16 - 4 * N) & 15));
+    }
+    return _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(t), (4 * (N - 4)) & 15));
+#elif DSP_SIMD_SSE2
+    return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a.v), (4 * N) & 15));
+#else
+    return a;
+#endif
+}
+
+// The highest lane
+inline float last(vfloat a) {
+#if DSP_SIMD_AVX512
+    return _mm512_cvtss_f32(_mm512_permutexvar_ps(_mm512_set1_epi32(15), a.v));
+#elif DSP_SIMD_AVX2
+    return _mm_cvtss_f32(_mm_shuffle_ps(_mm256_extractf128_ps(a.v, 1), _mm256_extractf128_ps(a.v, 1), 0xFF));
+#elif DSP_SIMD_SSE2
+    return _mm_cvtss_f32(_mm_shuffle_ps(a.v, a.v, 0xFF));
+#else
+    return a.v;
+#endif
+}
+
+// Transpose a kWidth x kWidth block in place: lane j of r[i] becomes lane i
+// of r[j]. Turns kWidth streams of kWidth samples into kWidth samples of
+// kWidth streams and back, for recursions that run across streams.
+inline void transpose(vfloat* r) {
+#if DSP_SIMD_AVX512
+    // 2x2 and 4x4 float blocks within each 128-bit lane, then the 4x4 lanes
+    __m512 t[16], u[16];
+    for (int i = 0; i < 16; i += 2) {
+        t[i] = _mm512_unpacklo_ps(r[i].v, r[i + 1].v);
+        t[i + 1] = _mm512_unpackhi_ps(r[i].v, r[i + 1].v);
+    }
+    for (int i = 0; i < 16; i += 4) {
+        u[i] = _mm512_shuffle_ps(t[i], t[i + 2], 0x44);
+        u[i + 1] = _mm512_shuffle_ps(t[i], t[i + 2], 0xEE);
+        u[i + 2] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+        u[i + 3] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    // u[4q + k] holds column 4L + k of rows 4q..4q+3 in lane L
+    for (int k = 0; k < 4; ++k) {
+        const __m512 v0 = _mm512_shuffle_f32x4(u[k], u[4 + k], 0x44);
+        const __m512 v1 = _mm512_shuffle_f32x4(u[k], u[4 + k], 0xEE);
+        const __m512 v2 = _mm512_shuffle_f32x4(u[8 + k], u[12 + k], 0x44);
+        const __m512 v3 = _mm512_shuffle_f32x4(u[8 + k], u[12 + k], 0xEE);
+        r[k] = _mm512_shuffle_f32x4(v0, v2, 0x88);
+        r[4 + k] = _mm512_shuffle_f32x4(v0, v2, 0xDD);
+        r[8 + k] = _mm512_shuffle_f32x4(v1, v3, 0x88);
+        r[12 + k] = _mm512_shuffle_f32x4(v1, v3, 0xDD);
+    }
+#elif DSP_SIMD_AVX2
+    __m256 t[8], u[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i].v, r[i + 1].v);
+        t[i + 1] = _mm256_unpackhi_ps(r[i].v, r[i + 1].v);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+        u[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+        u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+        u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    for (int k = 0; k < 4; ++k) {
+        r[k] = _mm256_permute2f128_ps(u[k], u[4 + k], 0x20);
+        r[4 + k] = _mm256_permute2f128_ps(u[k], u[4 + k], 0x31);
+    }
+#elif DSP_SIMD_SSE2
+    _MM_TRANSPOSE4_PS(r[0].v, r[1].v, r[2].v, r[3].v);
+#else
+    (void)r;
+#endif
+}
+
+} // namespace simd
+
+#endif // DSP_SIMD_H
@@ -0,0 +1,46 @@
+// Vectorized transcendental approximations on simd::vfloat.
+// Phases are expressed in turns (cycles, 1.0 = 2*pi) so range reduction is a
+// single round-and-subtract with no loss of precision for wrapped phases.
+
+#ifndef DSP_SIMD_MATH_H
+#define DSP_SIMD_MATH_H
+
+#include <cmath>
+
+#include "simd.h"
+#include "sine.h"
+
+namespace simd {
+
+// sin(2*pi*x): sine::Minimax<9>, the odd degree-9 polynomial on the folded
+// quarter wave (dsp/sine.h). Max approximation error 3.4e-9, well below float
+// resolution; the result is limited by float rounding (~1.2e-7). Accurate for
+// any |x| < 2^22; keep phases wrapped for best results.
+inline vfloat sin_turns(vfloat x) { return sine::Minimax<9>::sin_turns(x); }
+
+// cos(2*pi*x) = sin(2*pi*(x + 0.25))
+inline vfloat cos_turns(vfloat x) { return sin_turns(x + set1(0.25f)); }
+
+// 2^x. Taylor polynomial of 2^f on f = x - round(x) in [-0.5, 0.5] (relative
+// error 2.4e-7); x is clamped to [-126, 126] so the exponent stays normal.
+inline vfloat exp2(vfloat x) {
+    x = min(max(x, set1(-126.0f)), set1(126.0f));
+    vfloat n = round(x);
+    vfloat f = x - n;
+    vfloat p = fmadd(set1(1.5403530e-4f), f, set1(1.3333558e-3f));
+    p = fmadd(p, f, set1(9.6181291e-3f));
+    p = fmadd(p, f, set1(5.5504109e-2f));
+    p = fmadd(p, f, set1(2.4022651e-1f));
+    p = fmadd(p, f, set1(6.9314718e-1f));
+    p = fmadd(p, f, set1(1.0f));
+    return p * pow2i(n);
+}
+
+// Scalar versions with identical arithmetic, for loop tails and references.
+inline float sin_turns(float x) { return sine::Minimax<9>::sin_turns(x); }
+
+inline float cos_turns(float x) { return sin_turns(x + 0.25f); }
+
+} // namespace simd
+
+#endif // DSP_SIMD_MATH_H
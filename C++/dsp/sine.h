@@ -0,0 +1,404 @@
+// Sine oscillators on a 32-bit integer phase, with the evaluation method as a
+// policy, for the kernels and the host engines alike.
+// A phase counts 2^32 per turn, so it wraps for free through unsigned
+// overflow, and the phase increment of frequency f is f / sample_rate * 2^32
+// (negative frequencies wrap to the top of the range).
+//
+// Policies (each a struct of static functions; sin(phase) returns
+// sin(2 pi phase / 2^32) as float):
+//   Lut<Bits>      2^Bits points plus a guard point, linearly interpolated.
+//                  The table is computed at compile time (constexpr) and
+//                  becomes a ROM under HLS: 4 (2^Bits + 1) bytes.
+//   Cordic<Iters>  shift-and-add rotation on 30-bit fixed point, after
+//                  folding the phase to the nearest quadrant: no multipliers
+//                  and an angle table of Iters words.
+//   Minimax<Deg>   odd polynomial of degree 5, 7 or 9 on the folded quarter
+//                  wave; Minimax<9> is simd::sin_turns (dsp/simd_math.h).
+//   Rotator        a quadrature recurrence: one complex multiply per sample,
+//                  re-seeded from the integer phase every kResync steps.
+//                  It has state, so it exists only as Osc<Rotator>.
+// bench/sine_bench.cpp has the max error against sin in double and the host
+// cycles per sample of each. Lut<12> (3.5e-7), Cordic<24> (1.3e-7) and
+// Minimax<9> (1.7e-7) are all as close as float sinf (5.9e-7). The vector
+// Cordic rotates in float rather than in integers, so from 20 iterations
+// on it has float rounding: 4.1e-7 at Cordic<24>.
+//
+// The host functions take kWidth phases at a time, sin(const uint32_t*), and
+// Minimax and Cordic also take float turns, sin_turns(vfloat). Osc<Policy>
+// is the phase accumulator that drives any of them, sample by sample or a
+// block at a time.
+// The kernels pick their sine with SINE_POLICY (sine::Default).
+// Plain C++ with no intrinsics outside #ifndef __SYNTHESIS__, so synthesizable
+// kernels can include it too.
+
+#ifndef DSP_SINE_H
+#define DSP_SINE_H
+
+#include <cmath>
+#include <cstdint>
+
+#ifndef __SYNTHESIS__
+#include "simd.h"
+#endif
+
+// Sine evaluation of the kernels (C++/1.cpp, 2.cpp, 3.cpp, 5.cpp, 10.cpp,
+// 11.cpp and 12.cpp): any policy below
+#ifndef SINE_POLICY
+#define SINE_POLICY sine::Lut<12>
+#endif
+
+namespace sine {
+
+// constexpr stand-ins for sin, atan and sqrt (std:: ones are not constexpr),
+// in double and accurate to ~1e-15 over the ranges used here
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double round_cx(double x) {
+    return x >= 0.0 ? (double)(long long)(x + 0.5) : -(double)(long long)(0.5 - x);
+}
+
+// sin(2 pi t)
+constexpr double sin_turns_cx(double t) {
+    const double x = 2.0 * kPi * (t - round_cx(t));  // [-pi, pi]
+    const double x2 = x * x;
+    double term = x, sum = x;
+    for (int k = 1; k < 20; ++k) {
+        term *= -x2 / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// atan(x) for |x| <= 1: atan(1) exactly, otherwise the series on
+// atan(x) = 2 atan(x / (1 + sqrt(1 + x^2)))
+constexpr double sqrt_cx(double x) {
+    double r = x > 1.0 ? x : 1.0;
+    for (int k = 0; k < 64; ++k) r = 0.5 * (r + x / r);
+    return r;
+}
+
+constexpr double atan_cx(double x) {
+    if (x == 1.0) return kPi / 4.0;
+    const double y = x / (1.0 + sqrt_cx(1.0 + x * x));  // |y| <= 0.2
+    const double y2 = y * y;
+    double term = y, sum = y;
+    for (int k = 1; k < 24; ++k) {
+        term *= -y2;
+        sum += term / (2 * k + 1);
+    }
+    return 2.0 * sum;
+}
+
+template <int N>
+struct Table {
+    float v[N + 1];
+};
+
+// sin over one turn in N steps, plus the guard point v[N] = v[0]
+template <int N>
+constexpr Table<N> make_table() {
+    Table<N> t{};
+    for (int i = 0; i <= N; ++i) t.v[i] = (float)sin_turns_cx((double)i / N);
+    return t;
+}
+
+// CORDIC angles atan(2^-i) in phase units, and the gain 1 / prod sqrt(1 + 4^-i)
+// in 2^30 units
+template <int N>
+struct CordicTable {
+    int32_t angle[N];
+    int32_t gain;
+};
+
+template <int N>
+constexpr CordicTable<N> make_cordic() {
+    CordicTable<N> t{};
+    double gain = 1.0, p = 1.0;
+    for (int i = 0; i < N; ++i) {
+        t.angle[i] = (int32_t)round_cx(atan_cx(p) / (2.0 * kPi) * 4294967296.0);
+        gain /= sqrt_cx(1.0 + p * p);
+        p *= 0.5;
+    }
+    t.gain = (int32_t)round_cx(gain * 1073741824.0);
+    return t;
+}
+
+// Odd minimax polynomials for sin(2 pi r), r in [-0.25, 0.25], by Remez
+// exchange on the absolute error. Max approximation error 6.8e-5 (degree 5),
+// 6.0e-7 (7) and 3.4e-9 (9, below float rounding).
+struct Poly {
+    int count;      // Coefficients of r, r^3, r^5, ...
+    float c[5];
+};
+
+constexpr Poly minimax_poly(int degree) {
+    return degree == 5 ? Poly{3, {6.2812800766e+00f, -4.1095242687e+01f, 7.3585514735e+01f}}
+         : degree == 7 ? Poly{4, {6.2831640443e+00f, -4.1337142371e+01f, 8.1340768888e+01f, -7.0993433272e+01f}}
+         // The coefficients simd::sin_turns has always used (Lawson-weighted
+         // least squares, within 1e-7 of the Remez ones)
+         : Poly{5, {6.2831851600e+00f, -4.1341655024e+01f, 8.1601003692e+01f, -7.6549775068e+01f, 3.9536659239e+01f}};
+}
+
+} // namespace detail
+
+// Phase increment per sample for freq in Hz
+constexpr uint32_t phase_inc(double freq, double sample_rate) {
+    return (uint32_t)(int64_t)(freq / sample_rate * 4294967296.0);
+}
+
+// Phase of a position in turns (any |turns| < 2^31; whole turns drop out)
+inline uint32_t phase_of(float turns) { return (uint32_t)(int64_t)(turns * 4294967296.0f); }
+inline uint32_t phase_of(double turns) { return (uint32_t)(int64_t)(turns * 4294967296.0); }
+
+// A quarter turn: sin(phase + kQuarter) is cos(phase)
+constexpr uint32_t kQuarter = 1u << 30;
+
+template <int Bits>
+struct Lut {
+    static constexpr int kSize = 1 << Bits;
+    static constexpr int kFracBits = 32 - Bits;
+    static constexpr detail::Table<kSize> table = detail::make_table<kSize>();
+
+    static float sin(uint32_t phase) {
+        const uint32_t i = phase >> kFracBits;
+        const float frac = (float)(phase & ((1u << kFracBits) - 1)) * (1.0f / (1u << kFracBits));
+        return table.v[i] + (table.v[i + 1] - table.v[i]) * frac;
+    }
+
+    static float sin_turns(float x) { return sin(phase_of(x)); }
+
+#ifndef __SYNTHESIS__
+    static simd::vfloat sin(const uint32_t* phase) {
+        const simd::vfloat a = simd::gather(table.v, phase, kFracBits);
+        const simd::vfloat b = simd::gather(table.v + 1, phase, kFracBits);
+        return simd::fmadd(b - a, simd::phase_frac(phase, kFracBits), a);
+    }
+#endif
+};
+
+template <int Bits>
+constexpr detail::Table<Lut<Bits>::kSize> Lut<Bits>::table;
+
+template <int Iters>
+struct Cordic {
+    static_assert(Iters >= 1 && Iters <= 30, "Cordic: 1 to 30 iterations");
+    static constexpr detail::CordicTable<Iters> table = detail::make_cordic<Iters>();
+
+    static float sin(uint32_t phase) {
+        // Nearest quadrant q, and the rest r within +-1/8 turn of it
+        const uint32_t q = (phase + (kQuarter >> 1)) >> 30;
+        int32_t z = (int32_t)(phase - (q << 30));
+        int32_t x = table.gain, y = 0;  // cos, sin in 2^30 units
+        for (int i = 0; i < Iters; ++i) {
+#pragma HLS UNROLL
+            const int32_t dx = y >> i, dy = x >> i;
+            if (z >= 0) {
+                x -= dx;
+                y += dy;
+                z -= table.angle[i];
+            } else {
+                x += dx;
+                y -= dy;
+                z += table.angle[i];
+            }
+        }
+        const int32_t v = (q & 1) ? x : y;
+        return (float)((q & 2) ? -v : v) * (1.0f / (1 << 30));
+    }
+
+    static float sin_turns(float x) { return sin(phase_of(x)); }
+
+#ifndef __SYNTHESIS__
+    // The same rotations in float, on turns (simd.h has no integer
+    // vectors). At 12 and 16 iterations the last angle step sets the error
+    // of both paths; at 24 the float rounding does, 4.1e-7 against 1.3e-7.
+    static simd::vfloat sin_turns(simd::vfloat t) {
+        using namespace simd;
+        const vfloat r = t - round(t);              // [-0.5, 0.5]
+        const vfloat q = round(r * set1(4.0f));     // Nearest quadrant, -2..2
+        vfloat z = fmadd(q, set1(-0.25f), r);       // [-1/8, 1/8]
+        vfloat x = set1((float)table.gain * (1.0f / (1 << 30))), y = zero();
+        float p = 1.0f;
+        for (int i = 0; i < Iters; ++i) {
+            const vmask pos = z >= zero();
+            const vfloat dx = y * set1(p), dy = x * set1(p);
+            const vfloat a = set1((float)table.angle[i] * (1.0f / 4294967296.0f));
+            x = select(pos, x - dx, x + dx);
+            y = select(pos, y + dy, y - dy);
+            z = select(pos, z - a, z + a);
+            p *= 0.5f;
+        }
+        const vfloat qa = abs(q);
+        const vfloat v = select((qa > set1(0.5f)) & (qa < set1(1.5f)), x, y);
+        return select((q < set1(-0.5f)) | (q > set1(1.5f)), -v, v);
+    }
+
+    static simd::vfloat sin(const uint32_t* phase) { return sin_turns(simd::phase_turns(phase)); }
+#endif
+};
+
+template <int Iters>
+constexpr detail::CordicTable<Iters> Cordic<Iters>::table;
+
+template <int Degree>
+struct Minimax {
+    static_assert(Degree == 5 || Degree == 7 || Degree == 9, "Minimax: degree 5, 7 or 9");
+    static constexpr detail::Poly kPoly = detail::minimax_poly(Degree);
+
+    // r already in [-0.5, 0.5]
+    static float poly(float r) {
+        // Fold the outer quarters back: sin(2*pi*r) == sin(2*pi*(+-0.5 - r))
+        if (r > 0.25f) r = 0.5f - r;
+        else if (r < -0.25f) r = -0.5f - r;
+        const float r2 = r * r;
+        float p = kPoly.c[kPoly.count - 1];
+        for (int k = kPoly.count - 2; k >= 0; --k) p = p * r2 + kPoly.c[k];
+        return p * r;
+    }
+
+    static float sin(uint32_t phase) { return poly((float)(int32_t)phase * (1.0f / 4294967296.0f)); }
+
+    // Any |x| < 2^22 turns; keep phases wrapped for best results
+    static float sin_turns(float x) { return poly(x - std::nearbyint(x)); }
+
+#ifndef __SYNTHESIS__
+    static simd::vfloat poly(simd::vfloat r) {
+        using namespace simd;
+        const vfloat half = select(r < zero(), set1(-0.5f), set1(0.5f));
+        r = select(abs(r) > set1(0.25f), half - r, r);
+        const vfloat r2 = r * r;
+        vfloat p = set1(kPoly.c[kPoly.count - 1]);
+        for (int k = kPoly.count - 2; k >= 0; --k) p = fmadd(p, r2, set1(kPoly.c[k]));
+        return p * r;
+    }
+
+    static simd::vfloat sin_turns(simd::vfloat x) { return poly(x - simd::round(x)); }
+    static simd::vfloat sin(const uint32_t* phase) { return poly(simd::phase_turns(phase)); }
+#endif
+};
+
+template <int Degree>
+constexpr detail::Poly Minimax<Degree>::kPoly;
+
+// Quadrature recurrence: only usable through Osc<Rotator>
+struct Rotator {
+    static const int kResync = 64;  // Steps between re-seeds from the phase
+    typedef Minimax<9> Seed;        // Sine of the re-seeds and of the step
+};
+
+typedef SINE_POLICY Default;
+
+// Phase accumulator driving a policy
+template <typename Policy>
+struct Osc {
+    uint32_t phase = 0;
+    uint32_t inc = 0;
+
+    Osc() {}
+    Osc(double freq, double sample_rate) : inc(phase_inc(freq, sample_rate)) {}
+
+    void set_freq(double freq, double sample_rate) { inc = phase_inc(freq, sample_rate); }
+
+    float next() {
+        const float v = Policy::sin(phase);
+        phase += inc;
+        return v;
+    }
+
+#ifndef __SYNTHESIS__
+    void render(float* out, int n) {
+        const int W = simd::kWidth;
+        alignas(64) uint32_t p[simd::kWidth];
+        int s = 0;
+        for (; s + W <= n; s += W) {
+            for (int k = 0; k < W; ++k) p[k] = phase + (uint32_t)k * inc;
+            simd::storeu(out + s, Policy::sin(p));
+            phase += (uint32_t)W * inc;
+        }
+        for (; s < n; ++s) out[s] = next();
+    }
+#endif
+};
+
+// Rotates (cos, sin) by the increment each sample. The recurrence drifts by
+// float rounding, up to ~7e-8 per step, so it restarts from the exact integer
+// phase every kResync steps and whenever inc changes.
+template <>
+struct Osc<Rotator> {
+    uint32_t phase = 0;
+    uint32_t inc = 0;
+
+    Osc() {}
+    Osc(double freq, double sample_rate) : inc(phase_inc(freq, sample_rate)) {}
+
+    void set_freq(double freq, double sample_rate) { inc = phase_inc(freq, sample_rate); }
+
+    float next() {
+        if (left_ == 0 || inc != step_inc_) seed();
+        const float v = s_;
+        const float c = c_ * step_c_ - s_ * step_s_;
+        s_ = s_ * step_c_ + c_ * step_s_;
+        c_ = c;
+        phase += inc;
+        left_--;
+        return v;
+    }
+
+#ifndef __SYNTHESIS__
+    // Lane k runs phase + k inc and every lane steps by kWidth inc, so a
+    // re-seed covers kResync * kWidth samples
+    void render(float* out, int n) {
+        using namespace simd;
+        const int W = kWidth;
+        const int chunk = Rotator::kResync * W;
+        alignas(64) uint32_t p[kWidth], q[kWidth];
+        float step_s, step_c;
+        step(W * inc, step_s, step_c);
+        int s = 0;
+        while (s + W <= n) {
+            for (int k = 0; k < W; ++k) {
+                p[k] = phase + (uint32_t)k * inc;
+                q[k] = p[k] + kQuarter;
+            }
+            vfloat vs = Rotator::Seed::sin(p), vc = Rotator::Seed::sin(q);
+            const int end = s + chunk < n ? s + chunk : n / W * W;
+            for (; s + W <= end; s += W) {
+                storeu(out + s, vs);
+                const vfloat c = vc * set1(step_c) - vs * set1(step_s);
+                vs = fmadd(vs, set1(step_c), vc * set1(step_s));
+                vc = c;
+                phase += (uint32_t)W * inc;
+            }
+        }
+        left_ = 0;
+        for (; s < n; ++s) out[s] = next();
+    }
+#endif
+
+private:
+    float s_ = 0.0f, c_ = 1.0f, step_s_ = 0.0f, step_c_ = 1.0f;
+    uint32_t step_inc_ = 0;
+    int left_ = 0;
+
+    // sin and cos of the step, cos as 1 - 2 sin^2(half): the polynomial is
+    // accurate relative to small angles, but not near cos' peak of 1
+    static void step(uint32_t d, float& s, float& c) {
+        const float h = Rotator::Seed::sin((uint32_t)((int32_t)d / 2));
+        s = Rotator::Seed::sin(d);
+        c = 1.0f - 2.0f * h * h;
+    }
+
+    void seed() {
+        s_ = Rotator::Seed::sin(phase);
+        c_ = Rotator::Seed::sin(phase + kQuarter);
+        step(inc, step_s_, step_c_);
+        step_inc_ = inc;
+        left_ = Rotator::kResync;
+    }
+};
+
+} // namespace sine
+
+#endif // DSP_SINE_H
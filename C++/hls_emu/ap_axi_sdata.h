@@ -0,0 +1,30 @@
+// Host-side emulation of the AXI4-Stream side-channel structs (ap_axiu/ap_axis).
+
+#ifndef HLS_EMU_AP_AXI_SDATA_H
+#define HLS_EMU_AP_AXI_SDATA_H
+
+#include "ap_int.h"
+
+template<int D, int U, int TI, int TD>
+struct ap_axis {
+    ap_int<D> data;
+    ap_uint<(D + 7) / 8> keep;
+    ap_uint<(D + 7) / 8> strb;
+    ap_uint<U> user;
+    ap_uint<1> last;
+    ap_uint<TI> id;
+    ap_uint<TD> dest;
+};
+
+template<int D, int U, int TI, int TD>
+struct ap_axiu {
+    ap_uint<D> data;
+    ap_uint<(D + 7) / 8> keep;
+    ap_uint<(D + 7) / 8> strb;
+    ap_uint<U> user;
+    ap_uint<1> last;
+    ap_uint<TI> id;
+    ap_uint<TD> dest;
+};
+
+#endif // HLS_EMU_AP_AXI_SDATA_H
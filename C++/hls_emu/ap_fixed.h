@@ -0,0 +1,181 @@
+// Host-side emulation of the Vitis HLS fixed-point types.
+// The value is stored as a W-bit two's complement integer scaled by 2^-(W-I)
+// and re-quantized on every assignment using the selected quantization and
+// overflow modes (AP_TRN / AP_WRAP by default, as in the real library).
+// Arithmetic between fixed-point values is carried out in double precision and
+// quantized when the result is stored, which is exact for the W <= 32 formats
+// used by the kernels in this directory.
+
+#ifndef HLS_EMU_AP_FIXED_H
+#define HLS_EMU_AP_FIXED_H
+
+#include <cmath>
+#include <type_traits>
+
+#include "ap_int.h"
+
+enum ap_q_mode { AP_RND, AP_RND_ZERO, AP_RND_MIN_INF, AP_RND_INF, AP_RND_CONV, AP_TRN, AP_TRN_ZERO };
+enum ap_o_mode { AP_SAT, AP_SAT_ZERO, AP_SAT_SYM, AP_WRAP, AP_WRAP_SM };
+
+template<int _AP_W, int _AP_I, bool _AP_S, ap_q_mode _AP_Q, ap_o_mode _AP_O, int _AP_N>
+class ap_fixed_base {
+    static_assert(_AP_W >= 1 && _AP_W <= 53, "ap_fixed emulation supports 1..53 bits");
+
+public:
+    static const int width = _AP_W;
+    static const int iwidth = _AP_I;
+    static const int fwidth = _AP_W - _AP_I;
+
+    long long V;  // Raw two's complement value, sign/zero-extended
+
+    ap_fixed_base() : V(0) {}
+
+    template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    ap_fixed_base(T v) : V(quantize((double)v)) {}
+
+    template<int _AP_W2, int _AP_I2, bool _AP_S2, ap_q_mode _AP_Q2, ap_o_mode _AP_O2, int _AP_N2>
+    ap_fixed_base(const ap_fixed_base<_AP_W2, _AP_I2, _AP_S2, _AP_Q2, _AP_O2, _AP_N2>& o)
+        : V(quantize(o.to_double())) {}
+
+    template<int _AP_W2, bool _AP_S2>
+    ap_fixed_base(const ap_int_base<_AP_W2, _AP_S2>& o) : V(quantize((double)o.V)) {}
+
+    operator double() const { return to_double(); }
+
+    double to_double() const { return std::ldexp((double)V, -fwidth); }
+    float to_float() const { return (float)to_double(); }
+    int to_int() const { return (int)to_double(); }
+    long long to_int64() const { return (long long)to_double(); }
+
+    // Raw bit pattern access for code that wants to reason about the integer
+    // representation (e.g. Q-format comparisons).
+    long long raw() const { return V; }
+    static ap_fixed_base from_raw(long long r) { ap_fixed_base x; x.V = wrap(r); return x; }
+
+    double operator-() const { return -to_double(); }
+    double operator+() const { return to_double(); }
+
+    template<typename T> ap_fixed_base& operator+=(const T& v) { return *this = ap_fixed_base(to_double() + (double)v); }
+    template<typename T> ap_fixed_base& operator-=(const T& v) { return *this = ap_fixed_base(to_double() - (double)v); }
+    template<typename T> ap_fixed_base& operator*=(const T& v) { return *this = ap_fixed_base(to_double() * (double)v); }
+    template<typename T> ap_fixed_base& operator/=(const T& v) { return *this = ap_fixed_base(to_double() / (double)v); }
+
+    ap_fixed_base& operator++() { return *this += 1.0; }
+    ap_fixed_base& operator--() { return *this -= 1.0; }
+    ap_fixed_base operator++(int) { ap_fixed_base t = *this; *this += 1.0; return t; }
+    ap_fixed_base operator--(int) { ap_fixed_base t = *this; *this -= 1.0; return t; }
+
+    static long long wrap(long long r) {
+        const unsigned long long mask = (1ULL << _AP_W) - 1;
+        unsigned long long u = (unsigned long long)r & mask;
+        if (_AP_S && ((u >> (_AP_W - 1)) & 1ULL)) u |= ~mask;
+        return (long long)u;
+    }
+
+    static long long quantize(double x) {
+        if (x != x) return 0;
+        double s = std::ldexp(x, fwidth);
+        double q;
+        switch (_AP_Q) {
+        case AP_RND:         q = std::floor(s + 0.5); break;
+        case AP_RND_ZERO:    q = (s > 0) ? std::ceil(s - 0.5) : std::floor(s + 0.5); break;
+        case AP_RND_MIN_INF: q = std::ceil(s - 0.5); break;
+        case AP_RND_INF:     q = std::round(s); break;
+        case AP_RND_CONV:    q = std::nearbyint(s); break;
+        case AP_TRN_ZERO:    q = std::trunc(s); break;
+        case AP_TRN:
+        default:             q = std::floor(s); break;
+        }
+
+        const double max_raw = _AP_S ? std::ldexp(1.0, _AP_W - 1) - 1.0 : std::ldexp(1.0, _AP_W) - 1.0;
+        const double min_raw = _AP_S ? -std::ldexp(1.0, _AP_W - 1) : 0.0;
+        if (q > max_raw || q < min_raw) {
+            switch (_AP_O) {
+            case AP_SAT:      return (long long)(q > max_raw ? max_raw : min_raw);
+            case AP_SAT_ZERO: return 0;
+            case AP_SAT_SYM:  return (long long)(q > max_raw ? max_raw : (_AP_S ? -max_raw : 0.0));
+            default:
+                // Wrap: reduce modulo 2^W before the integer conversion so that
+                // out-of-range doubles do not hit undefined behaviour.
+                q = std::fmod(q, std::ldexp(1.0, _AP_W));
+                break;
+            }
+        }
+        return wrap((long long)q);
+    }
+};
+
+// As in the real library, ap_fixed and ap_ufixed are classes derived from
+// ap_fixed_base rather than aliases of it, so a class template specialized on
+// ap_fixed_base<...> does not match them (function templates still deduce
+// through the base).
+template<int _AP_W, int _AP_I, ap_q_mode _AP_Q = AP_TRN, ap_o_mode _AP_O = AP_WRAP, int _AP_N = 0>
+class ap_fixed : public ap_fixed_base<_AP_W, _AP_I, true, _AP_Q, _AP_O, _AP_N> {
+    typedef ap_fixed_base<_AP_W, _AP_I, true, _AP_Q, _AP_O, _AP_N> Base;
+
+public:
+    ap_fixed() {}
+
+    template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    ap_fixed(T v) : Base(v) {}
+
+    template<int _AP_W2, int _AP_I2, bool _AP_S2, ap_q_mode _AP_Q2, ap_o_mode _AP_O2, int _AP_N2>
+    ap_fixed(const ap_fixed_base<_AP_W2, _AP_I2, _AP_S2, _AP_Q2, _AP_O2, _AP_N2>& o) : Base(o) {}
+
+    template<int _AP_W2, bool _AP_S2>
+    ap_fixed(const ap_int_base<_AP_W2, _AP_S2>& o) : Base(o) {}
+};
+
+template<int _AP_W, int _AP_I, ap_q_mode _AP_Q = AP_TRN, ap_o_mode _AP_O = AP_WRAP, int _AP_N = 0>
+class ap_ufixed : public ap_fixed_base<_AP_W, _AP_I, false, _AP_Q, _AP_O, _AP_N> {
+    typedef ap_fixed_base<_AP_W, _AP_I, false, _AP_Q, _AP_O, _AP_N> Base;
+
+public:
+    ap_ufixed() {}
+
+    template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    ap_ufixed(T v) : Base(v) {}
+
+    template<int _AP_W2, int _AP_I2, bool _AP_S2, ap_q_mode _AP_Q2, ap_o_mode _AP_O2, int _AP_N2>
+    ap_ufixed(const ap_fixed_base<_AP_W2, _AP_I2, _AP_S2, _AP_Q2, _AP_O2, _AP_N2>& o) : Base(o) {}
+
+    template<int _AP_W2, bool _AP_S2>
+    ap_ufixed(const ap_int_base<_AP_W2, _AP_S2>& o) : Base(o) {}
+};
+
+// Mixed-type operators. Exact-match templates are needed so that expressions
+// like `fixed * 0.5f` do not become ambiguous between the built-in float and
+// double candidates reachable through the implicit conversion.
+#define AP_FIXED_TPL int W, int I, bool S, ap_q_mode Q, ap_o_mode O, int N
+#define AP_FIXED_T ap_fixed_base<W, I, S, Q, O, N>
+
+#define AP_FIXED_OP(OP, RET)                                                                   \
+template<AP_FIXED_TPL, int W2, int I2, bool S2, ap_q_mode Q2, ap_o_mode O2, int N2>            \
+inline RET operator OP(const AP_FIXED_T& a, const ap_fixed_base<W2, I2, S2, Q2, O2, N2>& b) {  \
+    return a.to_double() OP b.to_double();                                                     \
+}                                                                                              \
+template<AP_FIXED_TPL, typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0> \
+inline RET operator OP(const AP_FIXED_T& a, T b) { return a.to_double() OP (double)b; }       \
+template<AP_FIXED_TPL, typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0> \
+inline RET operator OP(T a, const AP_FIXED_T& b) { return (double)a OP b.to_double(); }       \
+template<AP_FIXED_TPL, int W2, bool S2>                                                        \
+inline RET operator OP(const AP_FIXED_T& a, const ap_int_base<W2, S2>& b) { return a.to_double() OP (double)b.V; } \
+template<AP_FIXED_TPL, int W2, bool S2>                                                        \
+inline RET operator OP(const ap_int_base<W2, S2>& a, const AP_FIXED_T& b) { return (double)a.V OP b.to_double(); }
+
+AP_FIXED_OP(+, double)
+AP_FIXED_OP(-, double)
+AP_FIXED_OP(*, double)
+AP_FIXED_OP(/, double)
+AP_FIXED_OP(==, bool)
+AP_FIXED_OP(!=, bool)
+AP_FIXED_OP(<, bool)
+AP_FIXED_OP(>, bool)
+AP_FIXED_OP(<=, bool)
+AP_FIXED_OP(>=, bool)
+
+#undef AP_FIXED_OP
+#undef AP_FIXED_T
+#undef AP_FIXED_TPL
+
+#endif // HLS_EMU_AP_FIXED_H
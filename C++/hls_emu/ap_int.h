@@ -0,0 +1,133 @@
+// Host-side emulation of the Vitis HLS arbitrary-precision integer types.
+// Lets the kernels in C++/ compile and run on a plain Linux box (CI, benchmarks)
+// without the Xilinx headers. Widths up to 64 bits are supported; the value is
+// kept sign- or zero-extended in a 64-bit word and wrapped on every assignment,
+// which matches the default AP_WRAP behaviour of the real types.
+
+#ifndef HLS_EMU_AP_INT_H
+#define HLS_EMU_AP_INT_H
+
+#include <type_traits>
+
+template<int _AP_W, bool _AP_S>
+class ap_int_base {
+    static_assert(_AP_W >= 1 && _AP_W <= 64, "ap_int emulation supports 1..64 bits");
+
+public:
+    typedef typename std::conditional<_AP_S, long long, unsigned long long>::type value_type;
+
+    value_type V;
+
+    ap_int_base() : V(0) {}
+
+    template<int _AP_W2, bool _AP_S2>
+    ap_int_base(const ap_int_base<_AP_W2, _AP_S2>& o) : V(wrap((unsigned long long)o.V)) {}
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    ap_int_base(T v) : V(wrap((unsigned long long)v)) {}
+
+    // Float to integer conversion truncates towards zero, as in C.
+    template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    ap_int_base(T v) : V(wrap((unsigned long long)(long long)v)) {}
+
+    operator value_type() const { return V; }
+
+    int to_int() const { return (int)V; }
+    unsigned to_uint() const { return (unsigned)V; }
+    long long to_int64() const { return (long long)V; }
+    unsigned long long to_uint64() const { return (unsigned long long)V; }
+    double to_double() const { return (double)V; }
+    int length() const { return _AP_W; }
+
+    bool operator[](int bit) const { return ((unsigned long long)V >> bit) & 1ULL; }
+
+    // Shifts keep the operand width, so bits shifted past the MSB are lost.
+    ap_int_base operator<<(int s) const { return ap_int_base((unsigned long long)V << s); }
+    ap_int_base operator>>(int s) const { return ap_int_base(V >> s); }
+    ap_int_base operator~() const { return ap_int_base(~(unsigned long long)V); }
+    long long operator-() const { return -(long long)V; }
+
+    template<typename T> ap_int_base& operator+=(const T& v) { return *this = ap_int_base((long long)V + (long long)v); }
+    template<typename T> ap_int_base& operator-=(const T& v) { return *this = ap_int_base((long long)V - (long long)v); }
+    template<typename T> ap_int_base& operator*=(const T& v) { return *this = ap_int_base((long long)V * (long long)v); }
+    template<typename T> ap_int_base& operator/=(const T& v) { return *this = ap_int_base(V / (value_type)v); }
+    template<typename T> ap_int_base& operator%=(const T& v) { return *this = ap_int_base(V % (value_type)v); }
+    template<typename T> ap_int_base& operator&=(const T& v) { return *this = ap_int_base(V & (value_type)v); }
+    template<typename T> ap_int_base& operator|=(const T& v) { return *this = ap_int_base(V | (value_type)v); }
+    template<typename T> ap_int_base& operator^=(const T& v) { return *this = ap_int_base(V ^ (value_type)v); }
+    ap_int_base& operator<<=(int s) { return *this = *this << s; }
+    ap_int_base& operator>>=(int s) { return *this = *this >> s; }
+
+    ap_int_base& operator++() { return *this += 1; }
+    ap_int_base& operator--() { return *this -= 1; }
+    ap_int_base operator++(int) { ap_int_base t = *this; *this += 1; return t; }
+    ap_int_base operator--(int) { ap_int_base t = *this; *this -= 1; return t; }
+
+    static value_type wrap(unsigned long long v) {
+        const unsigned long long mask = (_AP_W == 64) ? ~0ULL : ((1ULL << (_AP_W & 63)) - 1);
+        v &= mask;
+        if (_AP_S && _AP_W < 64 && ((v >> (_AP_W - 1)) & 1ULL)) v |= ~mask;
+        return (value_type)v;
+    }
+};
+
+template<int _AP_W> using ap_int = ap_int_base<_AP_W, true>;
+template<int _AP_W> using ap_uint = ap_int_base<_AP_W, false>;
+
+// Mixed-type operators. The real library returns a widened ap_int; here the
+// result is a plain 64-bit integer (or double when mixed with floating point),
+// which is exact for every width the kernels use.
+#define AP_INT_BIN_OP(OP)                                                                      \
+template<int W1, bool S1, int W2, bool S2>                                                     \
+inline long long operator OP(const ap_int_base<W1, S1>& a, const ap_int_base<W2, S2>& b) {     \
+    return (long long)a.V OP (long long)b.V;                                                   \
+}                                                                                              \
+template<int W, bool S, typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0> \
+inline long long operator OP(const ap_int_base<W, S>& a, T b) { return (long long)a.V OP (long long)b; } \
+template<int W, bool S, typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0> \
+inline long long operator OP(T a, const ap_int_base<W, S>& b) { return (long long)a OP (long long)b.V; }
+
+#define AP_INT_FLT_OP(OP)                                                                      \
+template<int W, bool S, typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0> \
+inline double operator OP(const ap_int_base<W, S>& a, T b) { return (double)a.V OP (double)b; } \
+template<int W, bool S, typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0> \
+inline double operator OP(T a, const ap_int_base<W, S>& b) { return (double)a OP (double)b.V; }
+
+#define AP_INT_CMP_OP(OP)                                                                      \
+template<int W1, bool S1, int W2, bool S2>                                                     \
+inline bool operator OP(const ap_int_base<W1, S1>& a, const ap_int_base<W2, S2>& b) {          \
+    return (long long)a.V OP (long long)b.V;                                                   \
+}                                                                                              \
+template<int W, bool S, typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0> \
+inline bool operator OP(const ap_int_base<W, S>& a, T b) {                                     \
+    return std::is_floating_point<T>::value ? (double)a.V OP (double)b : (long long)a.V OP (long long)b; \
+}                                                                                              \
+template<int W, bool S, typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0> \
+inline bool operator OP(T a, const ap_int_base<W, S>& b) {                                     \
+    return std::is_floating_point<T>::value ? (double)a OP (double)b.V : (long long)a OP (long long)b.V; \
+}
+
+AP_INT_BIN_OP(+)
+AP_INT_BIN_OP(-)
+AP_INT_BIN_OP(*)
+AP_INT_BIN_OP(/)
+AP_INT_BIN_OP(%)
+AP_INT_BIN_OP(&)
+AP_INT_BIN_OP(|)
+AP_INT_BIN_OP(^)
+AP_INT_FLT_OP(+)
+AP_INT_FLT_OP(-)
+AP_INT_FLT_OP(*)
+AP_INT_FLT_OP(/)
+AP_INT_CMP_OP(==)
+AP_INT_CMP_OP(!=)
+AP_INT_CMP_OP(<)
+AP_INT_CMP_OP(>)
+AP_INT_CMP_OP(<=)
+AP_INT_CMP_OP(>=)
+
+#undef AP_INT_BIN_OP
+#undef AP_INT_FLT_OP
+#undef AP_INT_CMP_OP
+
+#endif // HLS_EMU_AP_INT_H
@@ -0,0 +1,115 @@
+// Host-side emulation of the Vitis HLS math library (hls::sin, hls::sqrt, ...).
+// Floating-point overloads forward to <cmath>; fixed-point overloads evaluate in
+// double precision and quantize to the argument type, which is what the real
+// library's C simulation model does for the functions used in this directory.
+
+#ifndef HLS_EMU_HLS_MATH_H
+#define HLS_EMU_HLS_MATH_H
+
+#include <cmath>
+#include <type_traits>
+
+#include "ap_fixed.h"
+
+namespace hls {
+
+namespace detail {
+
+// Result type of the two-argument helpers: follows the first argument, with
+// integers promoted to double.
+template<typename T> struct math_ret { typedef double type; };
+template<> struct math_ret<float> { typedef float type; };
+template<int W, int I, bool S, ap_q_mode Q, ap_o_mode O, int N>
+struct math_ret<ap_fixed_base<W, I, S, Q, O, N>> { typedef ap_fixed_base<W, I, S, Q, O, N> type; };
+template<int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct math_ret<ap_fixed<W, I, Q, O, N>> { typedef ap_fixed<W, I, Q, O, N> type; };
+template<int W, int I, ap_q_mode Q, ap_o_mode O, int N>
+struct math_ret<ap_ufixed<W, I, Q, O, N>> { typedef ap_ufixed<W, I, Q, O, N> type; };
+
+template<typename T> inline double as_double(const T& v) { return (double)v; }
+
+} // namespace detail
+
+#define HLS_EMU_UNARY(NAME, FN)                                                                \
+inline float NAME(float x) { return std::FN(x); }                                              \
+inline double NAME(double x) { return std::FN(x); }                                            \
+template<typename T>                                                                           \
+inline typename std::enable_if<std::is_integral<T>::value, double>::type NAME(T x) { return std::FN((double)x); } \
+template<int W, int I, bool S, ap_q_mode Q, ap_o_mode O, int N>                                \
+inline ap_fixed_base<W, I, S, Q, O, N> NAME(const ap_fixed_base<W, I, S, Q, O, N>& x) {       \
+    return std::FN(x.to_double());                                                             \
+}                                                                                              \
+template<int W, int I, ap_q_mode Q, ap_o_mode O, int N>                                        \
+inline ap_fixed<W, I, Q, O, N> NAME(const ap_fixed<W, I, Q, O, N>& x) { return std::FN(x.to_double()); } \
+template<int W, int I, ap_q_mode Q, ap_o_mode O, int N>                                        \
+inline ap_ufixed<W, I, Q, O, N> NAME(const ap_ufixed<W, I, Q, O, N>& x) { return std::FN(x.to_double()); }
+
+HLS_EMU_UNARY(sin, sin)
+HLS_EMU_UNARY(cos, cos)
+HLS_EMU_UNARY(tan, tan)
+HLS_EMU_UNARY(asin, asin)
+HLS_EMU_UNARY(acos, acos)
+HLS_EMU_UNARY(atan, atan)
+HLS_EMU_UNARY(sinh, sinh)
+HLS_EMU_UNARY(cosh, cosh)
+HLS_EMU_UNARY(tanh, tanh)
+HLS_EMU_UNARY(exp, exp)
+HLS_EMU_UNARY(exp2, exp2)
+HLS_EMU_UNARY(log, log)
+HLS_EMU_UNARY(log2, log2)
+HLS_EMU_UNARY(log10, log10)
+HLS_EMU_UNARY(sqrt, sqrt)
+HLS_EMU_UNARY(floor, floor)
+HLS_EMU_UNARY(ceil, ceil)
+HLS_EMU_UNARY(round, round)
+HLS_EMU_UNARY(trunc, trunc)
+HLS_EMU_UNARY(fabs, fabs)
+HLS_EMU_UNARY(abs, fabs)
+
+#undef HLS_EMU_UNARY
+
+inline int abs(int x) { return x < 0 ? -x : x; }
+inline long long abs(long long x) { return x < 0 ? -x : x; }
+
+#define HLS_EMU_BINARY(NAME, FN)                                                               \
+template<typename T, typename U>                                                               \
+inline typename detail::math_ret<T>::type NAME(const T& x, const U& y) {                       \
+    return typename detail::math_ret<T>::type(std::FN(detail::as_double(x), detail::as_double(y))); \
+}
+
+HLS_EMU_BINARY(pow, pow)
+HLS_EMU_BINARY(atan2, atan2)
+HLS_EMU_BINARY(fmod, fmod)
+HLS_EMU_BINARY(hypot, hypot)
+
+#undef HLS_EMU_BINARY
+
+// C-style single-precision entry points
+inline float sinf(float x) { return std::sin(x); }
+inline float cosf(float x) { return std::cos(x); }
+inline float tanf(float x) { return std::tan(x); }
+inline float expf(float x) { return std::exp(x); }
+inline float logf(float x) { return std::log(x); }
+inline float sqrtf(float x) { return std::sqrt(x); }
+inline float fabsf(float x) { return std::fabs(x); }
+inline float floorf(float x) { return std::floor(x); }
+inline float fmodf(float x, float y) { return std::fmod(x, y); }
+inline float powf(float x, float y) { return std::pow(x, y); }
+inline float atan2f(float y, float x) { return std::atan2(y, x); }
+
+// min/max/clamp return the type of the first argument so that mixed calls such
+// as hls::max(fixed, 0.0f) stay unambiguous.
+template<typename T, typename U>
+inline T max(const T& a, const U& b) { return (a > b) ? a : T(b); }
+
+template<typename T, typename U>
+inline T min(const T& a, const U& b) { return (a < b) ? a : T(b); }
+
+template<typename T, typename L, typename H>
+inline T clamp(const T& x, const L& lo, const H& hi) {
+    return (x < lo) ? T(lo) : ((x > hi) ? T(hi) : x);
+}
+
+} // namespace hls
+
+#endif // HLS_EMU_HLS_MATH_H
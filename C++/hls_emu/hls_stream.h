@@ -0,0 +1,64 @@
+// Host-side emulation of hls::stream<T>.
+// An unbounded FIFO backed by std::deque, mirroring the C simulation model of
+// the real class: reading an empty stream prints a warning and returns a
+// default-constructed value instead of blocking.
+
+#ifndef HLS_EMU_HLS_STREAM_H
+#define HLS_EMU_HLS_STREAM_H
+
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <string>
+
+namespace hls {
+
+template<typename __STREAM_T__, int DEPTH = 0>
+class stream {
+public:
+    stream() {}
+    explicit stream(const char* name) : name_(name) {}
+
+    stream(const stream&) = delete;
+    stream& operator=(const stream&) = delete;
+
+    void write(const __STREAM_T__& v) { fifo_.push_back(v); }
+
+    __STREAM_T__ read() {
+        if (fifo_.empty()) {
+            std::fprintf(stderr, "WARNING: hls::stream '%s' read while empty\n", name_.c_str());
+            return __STREAM_T__();
+        }
+        __STREAM_T__ v = fifo_.front();
+        fifo_.pop_front();
+        return v;
+    }
+
+    void read(__STREAM_T__& v) { v = read(); }
+
+    bool read_nb(__STREAM_T__& v) {
+        if (fifo_.empty()) return false;
+        v = read();
+        return true;
+    }
+
+    bool write_nb(const __STREAM_T__& v) { write(v); return true; }
+
+    void operator<<(const __STREAM_T__& v) { write(v); }
+    void operator>>(__STREAM_T__& v) { read(v); }
+
+    bool empty() const { return fifo_.empty(); }
+    bool full() const { return false; }
+    std::size_t size() const { return fifo_.size(); }
+
+    // Host-only helper for testbenches: drop everything that was written.
+    void clear() { fifo_.clear(); }
+
+private:
+    std::deque<__STREAM_T__> fifo_;
+    std::string name_ = "anonymous";
+};
+
+} // namespace hls
+
+#endif // HLS_EMU_HLS_STREAM_H
@@ -0,0 +1,10 @@
+// Host-side emulation of hls_video.h. Only the AXI stream types are provided;
+// the kernels here do not use the hls::Mat / video library functions.
+
+#ifndef HLS_EMU_HLS_VIDEO_H
+#define HLS_EMU_HLS_VIDEO_H
+
+#include "ap_axi_sdata.h"
+#include "hls_stream.h"
+
+#endif // HLS_EMU_HLS_VIDEO_H
@@ -0,0 +1,116 @@
+// One aligned block of memory that long-lived DSP state is carved from, so
+// that many voices' delay lines sit together in as few pages (and TLB
+// entries) as possible instead of scattered across the heap. Allocation is a
+// bump pointer and everything is released with the arena.
+// With huge_pages set the block is mapped with MAP_HUGETLB when the system
+// has huge pages reserved, and otherwise 2 MB aligned and advised for
+// transparent huge pages (Linux only; elsewhere it is a plain aligned block).
+// Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef HOST_ARENA_H
+#define HOST_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "../dsp/delay.h"
+
+namespace host {
+
+class Arena {
+public:
+    static const size_t kHugePage = 2u << 20;
+
+    Arena(size_t bytes, bool huge_pages = false) : capacity_(bytes) {
+#ifdef __linux__
+        if (huge_pages) {
+            map_bytes_ = (bytes + kHugePage - 1) / kHugePage * kHugePage;
+            void* p = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                base_ = (char*)p;
+                huge_ = kHugeTlb;
+                return;
+            }
+            // Over-map by one huge page to align the start to one
+            map_bytes_ += kHugePage;
+            p = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                map_base_ = (char*)p;
+                base_ = (char*)(((uintptr_t)p + kHugePage - 1) & ~(uintptr_t)(kHugePage - 1));
+                huge_ = madvise(base_, capacity_, MADV_HUGEPAGE) == 0 ? kTransparent : kNone;
+                return;
+            }
+            map_bytes_ = 0;
+        }
+#else
+        (void)huge_pages;
+#endif
+        base_ = (char*)std::aligned_alloc(64, (bytes + 63) / 64 * 64);
+    }
+
+    ~Arena() {
+#ifdef __linux__
+        if (map_bytes_) {
+            munmap(map_base_ ? map_base_ : base_, map_bytes_);
+            return;
+        }
+#endif
+        std::free(base_);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t used() const { return used_; }
+
+    // "hugetlb", "thp" (advised, the kernel may or may not back it) or "none"
+    const char* page_kind() const { return huge_ == kHugeTlb ? "hugetlb" : (huge_ == kTransparent ? "thp" : "none"); }
+
+    // nullptr once the arena is exhausted
+    void* allocate(size_t bytes, size_t align = 64) {
+        if (!base_) return nullptr;
+        const size_t start = (used_ + align - 1) / align * align;
+        if (start + bytes > capacity_) return nullptr;
+        used_ = start + bytes;
+        return base_ + start;
+    }
+
+    // A cleared delay line that holds up to max_delay samples, cache-line
+    // aligned. Throws std::bad_alloc when the arena is full: size it with
+    // delay_bytes().
+    template <typename Codec>
+    delay::DelayLine<Codec> delay_line(uint32_t max_delay) {
+        typedef typename Codec::storage_type storage_type;
+        const uint32_t size = delay::pow2_at_least(max_delay);
+        storage_type* buf = (storage_type*)allocate(size * sizeof(storage_type));
+        if (!buf) throw std::bad_alloc();
+        return delay::DelayLine<Codec>(buf, size);
+    }
+
+    // Arena bytes one delay_line<Codec>(max_delay) takes, before alignment
+    template <typename Codec>
+    static size_t delay_bytes(uint32_t max_delay) {
+        return delay::pow2_at_least(max_delay) * sizeof(typename Codec::storage_type);
+    }
+
+private:
+    enum HugeKind { kNone, kTransparent, kHugeTlb };
+
+    char* base_ = nullptr;
+    char* map_base_ = nullptr;  // mmap start when base_ was aligned up
+    size_t map_bytes_ = 0;      // Non-zero when mmap'd
+    size_t capacity_;
+    size_t used_ = 0;
+    HugeKind huge_ = kNone;
+};
+
+} // namespace host
+
+#endif // HOST_ARENA_H
@@ -0,0 +1,133 @@
+// Convolution reverb for the host renderers: a measured impulse response,
+// loaded from a WAV file, run through dsp/convolver.h on each channel of a
+// rendered block and mixed with the dry signal. A mono IR feeds both
+// channels; a stereo one gives each channel its own side.
+// read_wav() takes 16, 24 or 32-bit PCM and 32-bit float files (plain or
+// WAVE_FORMAT_EXTENSIBLE). It does not resample: callers check sample_rate
+// against the renderer's.
+// Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef HOST_CONV_REVERB_H
+#define HOST_CONV_REVERB_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../dsp/convolver.h"
+
+namespace host {
+
+struct WavData {
+    int channels = 0;
+    int sample_rate = 0;
+    std::vector<float> samples;  // Interleaved frames, full scale +-1
+
+    int frames() const { return channels > 0 ? (int)(samples.size() / channels) : 0; }
+};
+
+// Returns false (and says why on stderr) on I/O errors and unsupported formats
+inline bool read_wav(const char* path, WavData& wav) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char buf[65536];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    std::fclose(f);
+
+    auto u16 = [&](size_t at) { return (uint32_t)bytes[at] | (uint32_t)bytes[at + 1] << 8; };
+    auto u32 = [&](size_t at) { return u16(at) | u16(at + 2) << 16; };
+    if (bytes.size() < 12 || std::memcmp(&bytes[0], "RIFF", 4) || std::memcmp(&bytes[8], "WAVE", 4)) {
+        std::fprintf(stderr, "%s: not a WAV file\n", path);
+        return false;
+    }
+    int format = 0, bits = 0;
+    size_t data = 0, data_bytes = 0;
+    for (size_t at = 12; at + 8 <= bytes.size();) {
+        const size_t size = u32(at + 4);
+        const size_t body = at + 8;
+        if (!std::memcmp(&bytes[at], "fmt ", 4) && size >= 16 && body + size <= bytes.size()) {
+            format = (int)u16(body);
+            wav.channels = (int)u16(body + 2);
+            wav.sample_rate = (int)u32(body + 4);
+            bits = (int)u16(body + 14);
+            if (format == 0xFFFE && size >= 26) format = (int)u16(body + 24);  // Extensible: sub-format GUID
+        } else if (!std::memcmp(&bytes[at], "data", 4)) {
+            data = body;
+            data_bytes = std::min(size, bytes.size() - body);
+        }
+        at = body + size + (size & 1);
+    }
+    const bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    const bool ieee = format == 3 && bits == 32;
+    if (!data || wav.channels <= 0 || !(pcm || ieee)) {
+        std::fprintf(stderr, "%s: unsupported WAV format %d, %d bits\n", path, format, bits);
+        return false;
+    }
+
+    const int width = bits / 8;
+    const size_t count = data_bytes / width / wav.channels * wav.channels;
+    wav.samples.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t at = data + i * width;
+        if (ieee) {
+            const uint32_t v = u32(at);
+            std::memcpy(&wav.samples[i], &v, 4);
+        } else {
+            // The sample as the top bytes of a 32-bit word (the bytes below
+            // it are cleared), so every width scales alike
+            uint32_t v = u32(at - 4 + width);
+            if (width == 2) v &= 0xFFFF0000u;
+            if (width == 3) v &= 0xFFFFFF00u;
+            wav.samples[i] = (int32_t)v * (1.0f / 2147483648.0f);
+        }
+    }
+    return true;
+}
+
+class ConvolutionReverb {
+public:
+    // A mono or stereo IR (channels past the second are ignored)
+    ConvolutionReverb(const WavData& ir, float wet, float dry, int block = 64)
+        : wet_(wet), dry_(dry), wet_l_(block), wet_r_(block) {
+        const int frames = ir.frames();
+        std::vector<float> side(frames);
+        for (int c = 0; c < 2; ++c) {
+            const int src = ir.channels > 1 ? c : 0;
+            for (int i = 0; i < frames; ++i) side[i] = ir.samples[(size_t)i * ir.channels + src];
+            conv_[c].reset(new conv::Convolver(side.data(), frames, block));
+        }
+    }
+
+    int block() const { return conv_[0]->block(); }
+    std::size_t bytes() const { return conv_[0]->bytes() + conv_[1]->bytes(); }
+
+    // In place; nframes a multiple of block()
+    void process(float* left, float* right, int nframes) {
+        const int b = block();
+        for (int i = 0; i + b <= nframes; i += b) {
+            conv_[0]->process(left + i, wet_l_.data());
+            conv_[1]->process(right + i, wet_r_.data());
+            for (int k = 0; k < b; ++k) {
+                left[i + k] = left[i + k] * dry_ + wet_l_[k] * wet_;
+                right[i + k] = right[i + k] * dry_ + wet_r_[k] * wet_;
+            }
+        }
+    }
+
+private:
+    float wet_, dry_;
+    std::unique_ptr<conv::Convolver> conv_[2];
+    std::vector<float> wet_l_, wet_r_;
+};
+
+} // namespace host
+
+#endif // HOST_CONV_REVERB_H
@@ -0,0 +1,273 @@
+// Real-time driver for the block renderers: a producer thread renders blocks
+// into a lock-free single-producer/single-consumer ring, and a sink thread
+// drains it on a clock at the nominal sample rate, like an audio device
+// callback would. The sink is a null or WAV file sink, so this runs headless.
+// Instrumented for buffer sizing: per-block render time percentiles, render
+// deadline misses (a block took longer than its own duration), sink xruns
+// (the ring ran dry at a device period; the sink starts once the ring holds
+// a period) and end-to-end latency (render start of a block to the sink
+// consuming its last frame).
+// Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef HOST_REALTIME_H
+#define HOST_REALTIME_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+// Fixed-capacity ring for one producer and one consumer thread. Capacity is
+// rounded up to a power of two; head and tail only ever grow and are masked
+// on access, so full and empty need no extra flag.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t min_capacity) {
+        size_t cap = 1;
+        while (cap < min_capacity) cap <<= 1;
+        data_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    size_t capacity() const { return data_.size(); }
+    size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+    // Producer side: copies up to n items, returns how many fit
+    size_t write(const T* items, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        n = std::min(n, capacity() - (head - tail));
+        for (size_t i = 0; i < n; ++i) data_[(head + i) & mask_] = items[i];
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side: copies up to n items out, returns how many there were
+    size_t read(T* items, size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        n = std::min(n, head - tail);
+        for (size_t i = 0; i < n; ++i) items[i] = data_[(tail + i) & mask_];
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> data_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};  // Next write, producer owned
+    alignas(64) std::atomic<size_t> tail_{0};  // Next read, consumer owned
+};
+
+// Consumer end of the engine: receives interleaved stereo frames once per
+// device period, from the sink thread.
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+    virtual void consume(const float* frames, int num_frames) = 0;
+};
+
+class NullSink : public AudioSink {
+public:
+    void consume(const float*, int) override {}
+};
+
+// 32-bit float stereo WAV, header patched on close
+class WavFileSink : public AudioSink {
+public:
+    WavFileSink(const char* path, int sample_rate) : sample_rate_(sample_rate) {
+        file_ = std::fopen(path, "wb");
+        if (file_) write_header();
+    }
+    ~WavFileSink() override { close(); }
+
+    bool ok() const { return file_ != nullptr; }
+
+    void consume(const float* frames, int num_frames) override {
+        if (file_) data_bytes_ += std::fwrite(frames, sizeof(float), 2 * num_frames, file_) * sizeof(float);
+    }
+
+    void close() {
+        if (!file_) return;
+        std::fseek(file_, 0, SEEK_SET);
+        write_header();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    void put32(uint32_t v) { std::fwrite(&v, 4, 1, file_); }
+    void put16(uint16_t v) { std::fwrite(&v, 2, 1, file_); }
+
+    void write_header() {
+        std::fwrite("RIFF", 1, 4, file_);
+        put32(36 + data_bytes_);
+        std::fwrite("WAVEfmt ", 1, 8, file_);
+        put32(16);
+        put16(3);  // IEEE float
+        put16(2);
+        put32(sample_rate_);
+        put32(sample_rate_ * 8);
+        put16(8);
+        put16(32);
+        std::fwrite("data", 1, 4, file_);
+        put32(data_bytes_);
+    }
+
+    std::FILE* file_ = nullptr;
+    int sample_rate_;
+    uint32_t data_bytes_ = 0;
+};
+
+struct RealtimeConfig {
+    int sample_rate = 44100;
+    int block_frames = 256;    // Producer render size
+    int period_frames = 256;   // Sink (device) period
+    int buffer_frames = 1024;  // Ring capacity in frames: the latency budget
+    double seconds = 2.0;      // Audio to play
+};
+
+struct RealtimeStats {
+    long long blocks = 0;
+    long long frames_played = 0;
+    long long deadline_misses = 0;  // Blocks that rendered slower than real time
+    long long xruns = 0;            // Sink periods the ring could not fill
+    long long xrun_frames = 0;      // Silence inserted for them
+    double render_p50_us = 0.0, render_p99_us = 0.0, render_p999_us = 0.0, render_max_us = 0.0;
+    double latency_mean_ms = 0.0, latency_max_ms = 0.0;
+    double cpu_load = 0.0;          // Render time over audio time
+};
+
+// Runs render(left, right, n) on a producer thread and sink on a clocked
+// sink thread until config.seconds of audio have been played.
+class RealtimeEngine {
+public:
+    typedef std::function<void(float* left, float* right, int num_frames)> RenderFn;
+
+    explicit RealtimeEngine(const RealtimeConfig& config) : config_(config) {}
+
+    RealtimeStats run(const RenderFn& render, AudioSink& sink) {
+        typedef std::chrono::steady_clock clock;
+        const RealtimeConfig& c = config_;
+        const long long total_frames = (long long)(c.seconds * c.sample_rate);
+        const double frame_s = 1.0 / c.sample_rate;
+
+        // The ring may round up; the producer keeps to the configured budget
+        const size_t capacity_samples = 2 * (size_t)std::max(c.buffer_frames, c.block_frames);
+        SpscRing<float> ring(capacity_samples);
+        // (end frame, render start) per block, for the latency measurement
+        struct Stamp {
+            long long end_frame;
+            clock::time_point start;
+        };
+        SpscRing<Stamp> stamps(capacity_samples / (2 * c.block_frames) + 2);
+        std::atomic<bool> stop{false};
+
+        RealtimeStats stats;
+        std::vector<double> render_us;
+        render_us.reserve(total_frames / c.block_frames + 1);
+
+        std::thread producer([&] {
+            std::vector<float> left(c.block_frames), right(c.block_frames), frames(2 * c.block_frames);
+            long long rendered = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                // Wait for room for a whole block within the latency budget
+                if (capacity_samples - ring.size() < 2 * (size_t)c.block_frames) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    continue;
+                }
+                const clock::time_point t0 = clock::now();
+                render(left.data(), right.data(), c.block_frames);
+                const double us = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+                render_us.push_back(us);
+                if (us * 1e-6 > c.block_frames * frame_s) stats.deadline_misses++;
+
+                for (int i = 0; i < c.block_frames; ++i) {
+                    frames[2 * i] = left[i];
+                    frames[2 * i + 1] = right[i];
+                }
+                rendered += c.block_frames;
+                const Stamp stamp = {rendered, t0};
+                while (stamps.write(&stamp, 1) == 0 && !stop.load(std::memory_order_relaxed)) std::this_thread::yield();
+                ring.write(frames.data(), frames.size());
+            }
+        });
+
+        // Pre-fill one period (or as much as the budget holds, in whole
+        // blocks) before the clock starts, as a device is primed before it
+        // runs, so the first render does not count as an xrun
+        const size_t budget_samples = capacity_samples / (2 * c.block_frames) * (2 * c.block_frames);
+        const size_t prefill = std::min({2 * (size_t)c.period_frames, budget_samples, 2 * (size_t)total_frames});
+        while (ring.size() < prefill) std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        // Sink: one period every period_frames / sample_rate, silence for
+        // whatever the ring cannot supply
+        std::vector<float> period(2 * c.period_frames);
+        const auto period_time = std::chrono::duration<double>(c.period_frames * frame_s);
+        clock::time_point next = clock::now();
+        double latency_sum = 0.0;
+        long long latency_count = 0;
+        Stamp pending = {-1, clock::time_point()};
+        long long played = 0;
+        long long consumed = 0;  // Frames taken from the ring
+        while (played < total_frames) {
+            next += std::chrono::duration_cast<clock::duration>(period_time);
+            std::this_thread::sleep_until(next);
+
+            const size_t got = ring.read(period.data(), period.size());
+            if (got < period.size()) {
+                stats.xruns++;
+                stats.xrun_frames += (period.size() - got) / 2;
+                std::fill(period.begin() + got, period.end(), 0.0f);
+            }
+            const int n = (int)std::min<long long>(c.period_frames, total_frames - played);
+            sink.consume(period.data(), n);
+            played += n;
+
+            // Blocks whose last frame has now been consumed
+            consumed += got / 2;
+            const clock::time_point now = clock::now();
+            for (;;) {
+                if (pending.end_frame < 0 && stamps.read(&pending, 1) == 0) break;
+                if (pending.end_frame > consumed) break;
+                const double ms = std::chrono::duration<double, std::milli>(now - pending.start).count();
+                latency_sum += ms;
+                stats.latency_max_ms = std::max(stats.latency_max_ms, ms);
+                latency_count++;
+                pending.end_frame = -1;
+            }
+        }
+        stop = true;
+        producer.join();
+
+        stats.frames_played = played;
+        stats.blocks = (long long)render_us.size();
+        if (latency_count) stats.latency_mean_ms = latency_sum / latency_count;
+        if (!render_us.empty()) {
+            double total_us = 0.0;
+            for (double us : render_us) total_us += us;
+            stats.cpu_load = total_us * 1e-6 / (render_us.size() * c.block_frames * frame_s);
+            std::sort(render_us.begin(), render_us.end());
+            auto pct = [&](double p) { return render_us[std::min(render_us.size() - 1, (size_t)(p * render_us.size()))]; };
+            stats.render_p50_us = pct(0.5);
+            stats.render_p99_us = pct(0.99);
+            stats.render_p999_us = pct(0.999);
+            stats.render_max_us = render_us.back();
+        }
+        return stats;
+    }
+
+private:
+    RealtimeConfig config_;
+};
+
+} // namespace host
+
+#endif // HOST_REALTIME_H
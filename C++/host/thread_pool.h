@@ -0,0 +1,152 @@
+// Work-stealing thread pool for the host-side (CPU) render and export paths.
+// A batch of `count` independent tasks is dealt to per-worker deques in
+// contiguous ranges. Each worker pops its own range from the front and, once it
+// runs dry, steals from the back of another worker's deque. The calling thread
+// takes part as worker 0, so a pool of size 1 runs everything inline.
+// Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef HOST_THREAD_POOL_H
+#define HOST_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+class ThreadPool {
+public:
+    typedef std::function<void(int task, int worker)> TaskFn;
+
+    // num_threads <= 0 uses every hardware thread
+    explicit ThreadPool(int num_threads = 0) {
+        if (num_threads <= 0) num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int w = 0; w < num_threads; ++w) queues_.emplace_back(new Queue);
+        for (int w = 1; w < num_threads; ++w) threads_.emplace_back(&ThreadPool::worker_loop, this, w);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : threads_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)queues_.size(); }
+
+    // Runs fn(task, worker) for every task in [0, count) and returns when all
+    // of them have finished. Not reentrant: call from one thread at a time.
+    void run(int count, const TaskFn& fn) {
+        if (count <= 0) return;
+        const int n = size();
+        for (int w = 0; w < n; ++w) {
+            Queue& q = *queues_[w];
+            std::lock_guard<std::mutex> lk(q.mutex);
+            for (int task = (int)((long long)count * w / n); task < (int)((long long)count * (w + 1) / n); ++task) {
+                q.tasks.push_back(task);
+            }
+        }
+        pending_ = count;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            fn_ = &fn;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drain(0, fn);
+
+        std::unique_lock<std::mutex> lk(mutex_);
+        done_.wait(lk, [&] { return pending_ == 0 && active_ == 0; });
+        fn_ = nullptr;
+    }
+
+    // Tasks taken from another worker's deque since construction
+    long long steals() const { return steals_; }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    bool pop_own(int worker, int& task) {
+        Queue& q = *queues_[worker];
+        std::lock_guard<std::mutex> lk(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(int worker, int& task) {
+        const int n = size();
+        for (int k = 1; k < n; ++k) {
+            Queue& q = *queues_[(worker + k) % n];
+            std::lock_guard<std::mutex> lk(q.mutex);
+            if (q.tasks.empty()) continue;
+            task = q.tasks.back();
+            q.tasks.pop_back();
+            ++steals_;
+            return true;
+        }
+        return false;
+    }
+
+    // Every task of a batch is queued before the workers are woken, so once no
+    // deque has work left this worker is done with the batch.
+    void drain(int worker, const TaskFn& fn) {
+        int task;
+        while (pop_own(worker, task) || steal(worker, task)) {
+            fn(task, worker);
+            if (--pending_ == 0) {
+                std::lock_guard<std::mutex> lk(mutex_);
+                done_.notify_all();
+            }
+        }
+    }
+
+    void worker_loop(int worker) {
+        unsigned long long seen = 0;
+        std::unique_lock<std::mutex> lk(mutex_);
+        for (;;) {
+            wake_.wait(lk, [&] { return stop_ || (generation_ != seen && fn_ != nullptr); });
+            if (stop_) return;
+            seen = generation_;
+            const TaskFn* fn = fn_;
+            ++active_;
+            lk.unlock();
+            drain(worker, *fn);
+            lk.lock();
+            if (--active_ == 0 && pending_ == 0) done_.notify_all();
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;                 // Guards fn_, generation_, active_ and stop_
+    std::condition_variable wake_;     // Signals a new batch (or shutdown) to the workers
+    std::condition_variable done_;     // Signals the caller that the batch has finished
+    const TaskFn* fn_ = nullptr;
+    unsigned long long generation_ = 0;
+    int active_ = 0;
+    bool stop_ = false;
+    std::atomic<int> pending_{0};
+    std::atomic<long long> steals_{0};
+};
+
+} // namespace host
+
+#endif // HOST_THREAD_POOL_H
@@ -0,0 +1,195 @@
+// Voice-parallel mixer: many independent synth instances (voices) rendered on
+// a pinned worker pool and summed into one stereo block.
+// Voices are dealt round-robin to the workers once, when added, so a voice
+// always runs on the same core and keeps its state in that core's cache.
+// For each block, every worker renders its voices into a private
+// cache-line-aligned buffer. The buffers are then summed pairwise in a tree
+// (worker w adds w + 1, then w + 2, w + 4, ...), so the sum takes log2(workers)
+// steps. Workers hand off through per-worker progress counters that are only
+// spun on, never locked, so nothing on the audio path takes a mutex. The
+// calling thread takes part as worker 0, so a mixer of size 1 renders inline.
+// Idle workers spin and then yield between blocks, so they keep their cores
+// busy; size the mixer to the cores set aside for audio.
+// Not for HLS: kernels only include this under #ifndef __SYNTHESIS__.
+
+#ifndef HOST_VOICE_MIXER_H
+#define HOST_VOICE_MIXER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace host {
+
+class VoiceMixer {
+public:
+    // Adds one voice's stereo output for n frames to left/right
+    typedef std::function<void(float* left, float* right, int num_frames)> VoiceFn;
+
+    // num_workers <= 0 uses every CPU the process may run on. With pin set,
+    // worker w > 0 is pinned to the w-th of those CPUs, modulo their count
+    // (Linux only); worker 0 is the calling thread and is left as it is.
+    VoiceMixer(int num_workers, int max_block_frames, bool pin = true) : max_block_(max_block_frames) {
+        const std::vector<int> cpus = allowed_cpus();
+        if (num_workers <= 0) num_workers = (int)cpus.size();
+        // Each buffer holds left then right, padded to whole cache lines
+        stride_ = (max_block_ + kLineFloats - 1) / kLineFloats * kLineFloats;
+        for (int w = 0; w < num_workers; ++w) {
+            workers_.emplace_back(new Worker);
+            workers_.back()->buffer.resize(2 * stride_ / kLineFloats);
+        }
+        for (int w = 1; w < num_workers; ++w) {
+            threads_.emplace_back(&VoiceMixer::worker_loop, this, w);
+            if (pin) pin_to_cpu(threads_.back().native_handle(), cpus[w % cpus.size()]);
+        }
+    }
+
+    ~VoiceMixer() {
+        stop_.store(true, std::memory_order_release);
+        for (std::thread& t : threads_) t.join();
+    }
+
+    VoiceMixer(const VoiceMixer&) = delete;
+    VoiceMixer& operator=(const VoiceMixer&) = delete;
+
+    int size() const { return (int)workers_.size(); }
+    int voices() const { return num_voices_; }
+
+    // Not safe while render() runs: add every voice before playback starts
+    void add_voice(const VoiceFn& voice) {
+        workers_[num_voices_ % size()]->voices.push_back(voice);
+        num_voices_++;
+    }
+
+    // Renders the mix of all voices into left/right (n <= max_block_frames).
+    // Call from one thread at a time, e.g. the RealtimeEngine producer.
+    void render(float* left, float* right, int n) {
+        n_ = n;
+        block_.fetch_add(1, std::memory_order_release);
+        run_worker(0, block_.load(std::memory_order_relaxed));
+        const float* sum = workers_[0]->data();
+        std::copy(sum, sum + n, left);
+        std::copy(sum + stride_, sum + stride_ + n, right);
+    }
+
+private:
+    static const int kLineFloats = 64 / sizeof(float);
+
+    struct alignas(64) Line {
+        float v[kLineFloats];
+    };
+
+    struct alignas(64) Worker {
+        // block * kLevels + level: this worker's buffer holds the sum of its
+        // 2^level subtree for that block
+        std::atomic<uint64_t> progress{0};
+        std::vector<VoiceFn> voices;
+        std::vector<Line> buffer;
+        float* data() { return buffer[0].v; }
+    };
+
+    static const uint64_t kLevels = 64;
+
+    // The CPUs in the calling thread's affinity mask (taskset, cgroups), in
+    // order; 0 .. hardware_concurrency - 1 where that mask is not available
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            const int n = (int)std::max(1u, std::thread::hardware_concurrency());
+            for (int cpu = 0; cpu < n; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    static void pin_to_cpu(std::thread::native_handle_type handle, int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(handle, sizeof(set), &set);
+#else
+        (void)handle;
+        (void)cpu;
+#endif
+    }
+
+    template <typename Ready>
+    static void spin_until(Ready ready) {
+        for (int spins = 0; !ready(); ++spins) {
+            if (spins > 1000) std::this_thread::yield();
+        }
+    }
+
+    void worker_loop(int w) {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t block = 0;
+            spin_until([&] {
+                block = block_.load(std::memory_order_acquire);
+                return block != seen || stop_.load(std::memory_order_acquire);
+            });
+            if (block == seen) return;  // Stopped
+            seen = block;
+            run_worker(w, block);
+        }
+    }
+
+    void run_worker(int w, uint64_t block) {
+        Worker& me = *workers_[w];
+        const int n = n_;
+        float* left = me.data();
+        float* right = left + stride_;
+        std::fill(left, left + n, 0.0f);
+        std::fill(right, right + n, 0.0f);
+        for (VoiceFn& voice : me.voices) voice(left, right, n);
+        me.progress.store(block * kLevels, std::memory_order_release);
+
+        // Tree reduction: at level k, workers that are multiples of 2^(k+1)
+        // take in the subtree of w + 2^k; the others are done
+        const int workers = size();
+        for (int level = 0; (1 << level) < workers; ++level) {
+            const int stride = 1 << level;
+            if (w % (2 * stride)) break;
+            if (w + stride < workers) {
+                Worker& other = *workers_[w + stride];
+                const uint64_t want = block * kLevels + level;
+                spin_until([&] { return other.progress.load(std::memory_order_acquire) >= want; });
+                const float* src = other.data();
+                for (int i = 0; i < n; ++i) left[i] += src[i];
+                for (int i = 0; i < n; ++i) right[i] += src[stride_ + i];
+            }
+            me.progress.store(block * kLevels + level + 1, std::memory_order_release);
+        }
+    }
+
+    int max_block_;
+    int stride_ = 0;
+    int num_voices_ = 0;
+    int n_ = 0;  // Frames in the current block, published by block_
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    alignas(64) std::atomic<uint64_t> block_{0};
+    std::atomic<bool> stop_{false};
+};
+
+} // namespace host
+
+#endif // HOST_VOICE_MIXER_H